@@ -0,0 +1,327 @@
+#ifndef SHARED_VAR_LIB__AGGREGATES_HPP
+#define SHARED_VAR_LIB__AGGREGATES_HPP
+
+/* Shared Variable Library
+ * Aggregates
+ * Author:  Yago T. de Mello
+ * e-mail:  yago.t.mello@gmail.com
+ * Version: 2.11.0 2022-07-09
+ * License: Apache 2.0
+ * C++20
+ */
+
+/*
+Copyright 2022 Yago Teodoro de Mello
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+    http://www.apache.org/licenses/LICENSE-2.0
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+// the lib
+#include "shared_var.hpp"
+
+
+// Internal use
+namespace shared::aggregate::impl {
+
+// Keys with prefixes, like std::string
+template <typename Key>
+concept prefixable = requires (const Key & key) {
+    { key.starts_with(key) } -> std::convertible_to<bool>;
+};
+
+} // namespace shared::aggregate::impl
+
+
+// module namespace
+namespace shared::aggregate {
+
+// Which vars are part of the aggregate
+enum selection_t : uint_fast8_t {
+    SELECT_PREFIX = 0,
+    SELECT_KEYS   = 1
+};
+
+// Sum, count, min and max of a set of vars of type T,
+// updated by shared::notify and shared::remove.
+// sum() and count() are O(1). min() and max() are O(1) unless the
+// extreme itself got worse, then they are recomputed once, on the next query.
+// The aggregate is a map observer: vars are added on their first notify,
+// and removed with shared::remove.
+// Floating point sums are updated by subtracting the old value and adding the new one,
+// which rounds on every change, so they are summed again after about count() changes.
+// Thread safe maps are locked by every member: the queries take the read lock,
+// except min() and max(), which may recompute the extremes under the write lock.
+template <typename T, typename Map, typename Key = typename Map::key_type>
+class aggregate_t {
+public:
+    using key_type = Key;
+    using value_type = T;
+    
+    // Use shared::aggregate::make_prefix_aggregate or make_keys_aggregate
+    aggregate_t(Map & mp, const shared::aggregate::selection_t selection, const Key & prefix, std::set<Key> keys) :
+        map_(&mp),
+        selection_(selection),
+        prefix_(prefix),
+        keys_(std::move(keys))
+    {
+        [[maybe_unused]] auto lock = shared::impl::lock_map(mp);
+        this->scan();
+        shared::observe_map(mp, &aggregate_t::on_event, this);
+    }
+    
+    // The aggregate address is the observer context, so it cannot move
+    aggregate_t(const aggregate_t &) = delete;
+    aggregate_t & operator =(const aggregate_t &) = delete;
+    
+    ~aggregate_t() {
+        [[maybe_unused]] auto lock = shared::impl::lock_map(*map_);
+        shared::unobserve_map(*map_, &aggregate_t::on_event, this);
+    }
+    
+    // Scans the map again, also picking the vars created without notify
+    void recompute() {
+        [[maybe_unused]] auto lock = shared::impl::lock_map(*map_);
+        this->scan();
+    }
+    
+// ==== queries ====
+    
+    T sum() const {
+        [[maybe_unused]] auto lock = shared::impl::read_lock_map(*map_);
+        return sum_;
+    }
+    
+    std::size_t count() const {
+        [[maybe_unused]] auto lock = shared::impl::read_lock_map(*map_);
+        return values_.size();
+    }
+    
+    // The value of a default constructed T if empty
+    T min() const {
+        [[maybe_unused]] auto lock = shared::impl::lock_map(*map_);
+        
+        if(is_min_dirty_) {
+            this->find_extremes();
+        }
+        
+        return min_;
+    }
+    
+    // The value of a default constructed T if empty
+    T max() const {
+        [[maybe_unused]] auto lock = shared::impl::lock_map(*map_);
+        
+        if(is_max_dirty_) {
+            this->find_extremes();
+        }
+        
+        return max_;
+    }
+    
+    // True if the var is part of the aggregate
+    bool contains(const Key & key) const {
+        [[maybe_unused]] auto lock = shared::impl::read_lock_map(*map_);
+        return values_.contains(key);
+    }
+    
+private:
+    Map * map_;
+    shared::aggregate::selection_t selection_;
+    Key prefix_;
+    std::set<Key> keys_;
+    
+    // Last value seen of every var, used to undo its contribution
+    std::map<Key, T> values_;
+    
+    T sum_ = T();
+    mutable T min_ = T();
+    mutable T max_ = T();
+    mutable bool is_min_dirty_ = true;
+    mutable bool is_max_dirty_ = true;
+    
+    // Changes since the sum was last computed from the values
+    std::size_t updates_ = 0;
+    
+    // The map is already locked
+    void scan() {
+        values_.clear();
+        
+        if(selection_ == shared::aggregate::SELECT_KEYS) {
+            for(const Key & key : keys_) {
+                auto it = map_->find(key);
+                
+                if(it != map_->end() && shared::impl::are_types_equal<T>(it->second)) {
+                    values_[key] = *shared::impl::info_to_data_ptr<T>(it->second);
+                }
+            }
+        }
+        else if constexpr(shared::aggregate::impl::prefixable<Key>) {
+            // The map is ordered, the prefix is a contiguous range
+            for(auto it = map_->lower_bound(prefix_); it != map_->end() && it->first.starts_with(prefix_); ++it) {
+                const shared::info_t<Key> & info = it->second;
+                
+                if(shared::impl::are_types_equal<T>(info)) {
+                    values_[info.key] = *shared::impl::info_to_data_ptr<T>(info);
+                }
+            }
+        }
+        
+        this->sum_values();
+        
+        is_min_dirty_ = true;
+        is_max_dirty_ = true;
+    }
+    
+    void sum_values() {
+        sum_ = T();
+        updates_ = 0;
+        
+        for(const auto & [key, value] : values_) {
+            sum_ += value;
+        }
+    }
+    
+    // The rounding errors of floating point sums add up,
+    // summing again every count() changes keeps the updates O(1) amortized
+    void count_update() {
+        if constexpr(std::is_floating_point_v<T>) {
+            if(++updates_ > values_.size()) {
+                this->sum_values();
+            }
+        }
+    }
+    
+    bool is_selected(const Key & key) const {
+        if(selection_ == shared::aggregate::SELECT_KEYS) {
+            return keys_.contains(key);
+        }
+        else if constexpr(shared::aggregate::impl::prefixable<Key>) {
+            return key.starts_with(prefix_);
+        }
+        else {
+            return false;
+        }
+    }
+    
+    void find_extremes() const {
+        min_ = T();
+        max_ = T();
+        
+        auto it = values_.begin();
+        
+        if(it != values_.end()) {
+            min_ = it->second;
+            max_ = it->second;
+            
+            for(++it; it != values_.end(); ++it) {
+                if(it->second < min_) min_ = it->second;
+                if(max_ < it->second) max_ = it->second;
+            }
+        }
+        
+        is_min_dirty_ = false;
+        is_max_dirty_ = false;
+    }
+    
+    void on_change(const Key & key, const T & value) {
+        auto [it, is_new] = values_.try_emplace(key, value);
+        
+        if(is_new) {
+            sum_ += value;
+            
+            if(values_.size() == 1) {
+                // The first value is both extremes
+                min_ = value;
+                max_ = value;
+                is_min_dirty_ = false;
+                is_max_dirty_ = false;
+            }
+            else {
+                if(!is_min_dirty_ && value < min_) min_ = value;
+                if(!is_max_dirty_ && max_ < value) max_ = value;
+            }
+        }
+        else {
+            const T old_value = it->second;
+            it->second = value;
+            
+            sum_ -= old_value;
+            sum_ += value;
+            this->count_update();
+            
+            if(!is_min_dirty_) {
+                if(value < min_) min_ = value;
+                // The min got bigger, only a scan finds the new min
+                else if(!(min_ < old_value) && min_ < value) is_min_dirty_ = true;
+            }
+            
+            if(!is_max_dirty_) {
+                if(max_ < value) max_ = value;
+                // The max got smaller, only a scan finds the new max
+                else if(!(old_value < max_) && value < max_) is_max_dirty_ = true;
+            }
+        }
+    }
+    
+    void on_remove(const Key & key) {
+        auto it = values_.find(key);
+        if(it == values_.end()) return;
+        
+        const T old_value = it->second;
+        values_.erase(it);
+        
+        sum_ -= old_value;
+        this->count_update();
+        
+        if(!(min_ < old_value)) is_min_dirty_ = true;
+        if(!(old_value < max_)) is_max_dirty_ = true;
+    }
+    
+    // Called by shared::notify and shared::remove
+    static bool on_event(void * context, const shared::info_t<Key> & info, const shared::event_t event) {
+        aggregate_t & self = *reinterpret_cast<aggregate_t *>(context);
+        
+        if(!self.is_selected(info.key) || !shared::impl::are_types_equal<T>(info)) return true;
+        
+        if(event == shared::VAR_CHANGED) {
+            self.on_change(info.key, *shared::impl::info_to_data_ptr<T>(info));
+        }
+        else {
+            self.on_remove(info.key);
+        }
+        
+        return true;
+    }
+};
+
+// Aggregates every var of type T with a key starting with "prefix",
+// including vars created later (once notified)
+template <typename T, typename Map, typename Key = typename Map::key_type>
+requires shared::aggregate::impl::prefixable<Key>
+inline shared::aggregate::aggregate_t<T, Map> make_prefix_aggregate(
+    Map & mp,
+    const std::type_identity_t<Key> & prefix
+) {
+    return shared::aggregate::aggregate_t<T, Map>(mp, shared::aggregate::SELECT_PREFIX, prefix, {});
+}
+
+// Aggregates the vars of type T in "keys"
+template <typename T, typename Map, typename Key = typename Map::key_type>
+inline shared::aggregate::aggregate_t<T, Map> make_keys_aggregate(
+    Map & mp,
+    std::set<Key> keys
+) {
+    return shared::aggregate::aggregate_t<T, Map>(mp, shared::aggregate::SELECT_KEYS, Key(), std::move(keys));
+}
+
+} // namespace shared::aggregate
+
+
+#endif // SHARED_VAR_LIB__AGGREGATES_HPP
@@ -0,0 +1,237 @@
+#ifndef SHARED_VAR_LIB__ARENA_SNAPSHOT_HPP
+#define SHARED_VAR_LIB__ARENA_SNAPSHOT_HPP
+
+/* Shared Variable Library
+ * Arena snapshot
+ * Author:  Yago T. de Mello
+ * e-mail:  yago.t.mello@gmail.com
+ * Version: 2.11.0 2022-07-09
+ * License: Apache 2.0
+ * C++20
+ */
+
+/*
+Copyright 2022 Yago Teodoro de Mello
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+    http://www.apache.org/licenses/LICENSE-2.0
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+// std::memcpy
+#include <cstring>
+
+// the lib
+#include "shared_var.hpp"
+
+
+// module namespace
+namespace shared::arena {
+
+// A saved var, without its value
+template <typename Key>
+struct entry_t {
+    using key_type = Key;
+    
+    key_type key;
+    key_type group_id;
+    const std::type_info * type_id;
+    typename shared::info_t<Key>::allocator_type allocator;
+    typename shared::info_t<Key>::copier_type copier;
+    typename shared::info_t<Key>::formatter_type formatter;
+    const shared::layout_t * layout;
+    
+    // Trivially copyable values: position of the value in the arena
+    std::size_t offset;
+    
+    // Other values: a copy made by the allocator, nullptr for the trivial ones
+    std::shared_ptr<void> value;
+};
+
+// The same data as shared::snapshot, but the trivially copyable values
+// are packed in a single buffer instead of one allocation per var.
+// Can be restored many times.
+template <typename Key>
+struct snapshot_t {
+    using key_type = Key;
+    
+    // In the map order
+    std::vector<shared::arena::entry_t<Key>> entries;
+    
+    // The values of the trivially copyable vars, see entry_t::offset.
+    // Read and written with std::memcpy only, so the buffer has no objects
+    // (the offsets are aligned anyway, for faster copies)
+    std::vector<std::byte> arena;
+    
+    std::size_t size() const noexcept {
+        return entries.size();
+    }
+    
+    bool empty() const noexcept {
+        return entries.empty();
+    }
+};
+
+} // namespace shared::arena
+
+
+// Internal use
+namespace shared::arena::impl {
+
+// Trivially copyable vars are copied with std::memcpy
+template <typename Key>
+inline bool is_trivial(const shared::info_t<Key> & info) {
+    return info.layout != nullptr && info.layout->is_trivially_copyable;
+}
+
+// Rounds "offset" up to a multiple of "alignment" (a power of 2)
+inline std::size_t align_up(const std::size_t offset, const std::size_t alignment) {
+    return (offset + alignment - 1) & ~(alignment - 1);
+}
+
+// Creates a var from the saved data, on newly allocated memory
+template <typename Key>
+inline shared::info_t<Key> make_info(
+    const shared::arena::entry_t<Key> & entry,
+    const std::byte * arena
+) {
+    shared::info_t<Key> info;
+    
+    info.group_id  = entry.group_id;
+    info.type_id   = entry.type_id;
+    info.key       = entry.key;
+    info.allocator = entry.allocator;
+    info.copier    = entry.copier;
+    info.formatter = entry.formatter;
+    info.layout    = entry.layout;
+    
+    if(entry.value == nullptr) {
+        // Default constructed, then overwritten by the saved bytes
+        shared::impl::allocate_and_notify_subscribers(info, nullptr);
+        std::memcpy(info.ptr.get(), arena + entry.offset, entry.layout->size);
+    }
+    else {
+        shared::impl::allocate_and_notify_subscribers(info, entry.value.get());
+    }
+    
+    return info;
+}
+
+} // namespace shared::arena::impl
+
+
+// module namespace
+namespace shared::arena {
+
+// Same as shared::snapshot, with the trivially copyable values in one buffer.
+// The other values are copied by their allocators.
+template <typename Map, typename Key = typename Map::key_type>
+inline shared::arena::snapshot_t<Key> snapshot(const Map & mp) {
+    SHARED_VAR_TIME_SCOPE(SNAPSHOT_NS);
+    
+    shared::arena::snapshot_t<Key> data;
+    data.entries.reserve(mp.size());
+    
+    // Lay out the arena and save everything but the values
+    std::size_t arena_size = 0;
+    
+    for(const auto & [key, info] : mp) {
+        std::size_t offset = 0;
+        
+        if(shared::arena::impl::is_trivial(info)) {
+            offset = shared::arena::impl::align_up(arena_size, info.layout->alignment);
+            arena_size = offset + info.layout->size;
+        }
+        
+        data.entries.push_back({
+            info.key,
+            info.group_id,
+            info.type_id,
+            info.allocator,
+            info.copier,
+            info.formatter,
+            info.layout,
+            offset,
+            nullptr
+        });
+    }
+    
+    // Then copy the values
+    SHARED_VAR_COUNT(ALLOCATIONS, 1);
+    data.arena.resize(arena_size);
+    
+    auto entry = data.entries.begin();
+    
+    for(const auto & [key, info] : mp) {
+        if(shared::arena::impl::is_trivial(info)) {
+            std::memcpy(data.arena.data() + entry->offset, info.ptr.get(), info.layout->size);
+        }
+        else {
+            SHARED_VAR_COUNT(ALLOCATIONS, 1);
+            entry->value = info.allocator(info.ptr.get());
+        }
+        
+        ++entry;
+    }
+    
+    return data;
+}
+
+// Same as shared::restore. Trivially copyable values are copied from the arena
+// with std::memcpy, the others with the copier of the var.
+// Topology changes may break views:
+// Views of undo-ed vars may become dangling.
+// Re-created vars don't have connections with their old views.
+// Existing vars retain their views, updating only the value.
+template <typename Map, typename Key = typename Map::key_type>
+inline void restore(
+    Map & mp,
+    const shared::arena::snapshot_t<Key> & data
+) {
+    SHARED_VAR_TIME_SCOPE(RESTORE_NS);
+    
+    // The entries are in the map order, so the var to restore is usually
+    // the one after the last restored, saving a lookup
+    auto it_next = mp.begin();
+    
+    for(const shared::arena::entry_t<Key> & entry : data.entries) {
+        // Check if exists a var with the same key in the new map
+        auto it_dest = (it_next != mp.end() && it_next->first == entry.key) ? it_next : mp.find(entry.key);
+        
+        if(it_dest != mp.end()) {
+            it_next = std::next(it_dest);
+            shared::info_t<Key> & info_dest = shared::impl::iter_to_info<Map>(it_dest);
+            
+            if(entry.type_id == info_dest.type_id) {
+                // Same type, only the value is restored
+                if(entry.value == nullptr) {
+                    std::memcpy(info_dest.ptr.get(), data.arena.data() + entry.offset, entry.layout->size);
+                }
+                else {
+                    entry.copier(info_dest.ptr.get(), entry.value.get());
+                }
+            }
+            else {
+                // A new var has overwriten the old one
+                shared::impl::disconnect_subscribers(info_dest);
+                info_dest = shared::arena::impl::make_info(entry, data.arena.data());
+            }
+        }
+        else {
+            // The var was removed, re-created alone in its group
+            shared::info_t<Key> & info_new = mp[entry.key];
+            info_new = shared::arena::impl::make_info(entry, data.arena.data());
+            info_new.group_id = info_new.key;
+        }
+    }
+}
+
+} // namespace shared::arena
+
+
+#endif // SHARED_VAR_LIB__ARENA_SNAPSHOT_HPP
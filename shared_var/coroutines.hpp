@@ -0,0 +1,261 @@
+#ifndef SHARED_VAR_LIB__COROUTINES_HPP
+#define SHARED_VAR_LIB__COROUTINES_HPP
+
+/* Shared Variable Library
+ * Coroutines
+ * Author:  Yago T. de Mello
+ * e-mail:  yago.t.mello@gmail.com
+ * Version: 2.11.0 2022-07-09
+ * License: Apache 2.0
+ * C++20
+ */
+
+/*
+Copyright 2022 Yago Teodoro de Mello
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+    http://www.apache.org/licenses/LICENSE-2.0
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+// std::coroutine_handle
+#include <coroutine>
+
+// the executor queue is protected by a std::mutex
+#include <mutex>
+
+// the lib
+#include "shared_var.hpp"
+
+
+// module namespace
+namespace shared::coro {
+
+// Anything able to resume a coroutine later
+template <typename Executor>
+concept executor = requires (Executor & ex, std::coroutine_handle<> handle) {
+    ex.post(handle);
+};
+
+// Queues the coroutines resumed by the awaitables.
+// The coroutines are resumed by the thread calling run(),
+// writers only push a handle to the queue.
+class queue_executor_t {
+public:
+    // Queues the coroutine, thread safe
+    void post(std::coroutine_handle<> handle) {
+        std::scoped_lock lock(mutex_);
+        queue_.push_back(handle);
+    }
+    
+    // Resumes every queued coroutine.
+    // Returns how many coroutines were resumed.
+    std::size_t run() {
+        std::vector<std::coroutine_handle<>> ready;
+        
+        {
+            std::scoped_lock lock(mutex_);
+            ready.swap(queue_);
+        }
+        
+        for(std::coroutine_handle<> handle : ready) {
+            handle.resume();
+        }
+        
+        return ready.size();
+    }
+    
+    // True if no coroutine is waiting to be resumed
+    bool empty() {
+        std::scoped_lock lock(mutex_);
+        return queue_.empty();
+    }
+    
+private:
+    std::mutex mutex_;
+    std::vector<std::coroutine_handle<>> queue_;
+};
+
+} // namespace shared::coro
+
+
+// Internal use
+namespace shared::coro::impl {
+
+// Predicate used by shared::coro::changed, any write resumes the coroutine
+struct any_change_t {
+    template <typename T>
+    constexpr bool operator ()(const T &) const {
+        return true;
+    }
+};
+
+} // namespace shared::coro::impl
+
+
+// module namespace
+namespace shared::coro {
+
+// Suspends the coroutine until the var is changed (see shared::notify)
+// and "predicate" returns true for the new value.
+// Only notified changes resume the coroutine, see view.set_and_notify.
+// co_await returns false if the var doesn't exist or was removed.
+// The awaiter is an observer of the var, no thread is used while waiting.
+template <shared::storable T, typename Map, shared::coro::executor Executor, typename Predicate>
+class change_awaiter_t {
+public:
+    using key_type = typename Map::key_type;
+    using value_type = T;
+    
+    change_awaiter_t(Map & mp, const key_type & key, Executor & ex, Predicate predicate) :
+        map_(&mp),
+        key_(key),
+        executor_(&ex),
+        predicate_(std::move(predicate)) {}
+        
+    // The awaiter address is the observer context, so it cannot move
+    change_awaiter_t(const change_awaiter_t &) = delete;
+    change_awaiter_t & operator =(const change_awaiter_t &) = delete;
+    
+    // A coroutine destroyed while suspended must not leave a dangling observer
+    ~change_awaiter_t() {
+        [[maybe_unused]] auto lock = shared::impl::lock_map(*map_);
+        
+        if(is_registered_) {
+            shared::unobserve(*map_, key_, &change_awaiter_t::on_event, this);
+        }
+    }
+    
+    // "changed" always waits for the next write,
+    // "until" does not suspend if the predicate already holds
+    bool await_ready() {
+        if constexpr(waits_for_next_change) {
+            return false;
+        }
+        else {
+            [[maybe_unused]] auto lock = shared::impl::lock_map(*map_);
+            
+            auto it = map_->find(key_);
+            
+            // A var of another type can't be read as T
+            if(it == map_->end() || !shared::impl::are_types_equal<T>(it->second)) {
+                is_valid_ = false;
+                return true;
+            }
+            
+            is_valid_ = true;
+            return predicate_(*shared::impl::info_to_data_ptr<T>(it->second));
+        }
+    }
+    
+    // Registers the awaiter as an observer of the var
+    bool await_suspend(std::coroutine_handle<> handle) {
+        [[maybe_unused]] auto lock = shared::impl::lock_map(*map_);
+        
+        auto it = map_->find(key_);
+        
+        // The var may have been removed since await_ready
+        if(it == map_->end() || !shared::impl::are_types_equal<T>(it->second)) {
+            is_valid_ = false;
+            return false;
+        }
+        
+        // Or changed: a notify between await_ready and the registration
+        // would be lost, so the predicate is checked again under the lock
+        if constexpr(!waits_for_next_change) {
+            is_valid_ = true;
+            if(predicate_(*shared::impl::info_to_data_ptr<T>(it->second))) return false;
+        }
+        
+        handle_ = handle;
+        is_registered_ = true;
+        it->second.observers.push_back({&change_awaiter_t::on_event, this});
+        return true;
+    }
+    
+    bool await_resume() const {
+        return is_valid_;
+    }
+    
+private:
+    static constexpr bool waits_for_next_change = std::is_same_v<Predicate, shared::coro::impl::any_change_t>;
+    
+    Map * map_;
+    key_type key_;
+    Executor * executor_;
+    Predicate predicate_;
+    std::coroutine_handle<> handle_;
+    bool is_registered_ = false;
+    bool is_valid_ = true;
+    
+    // Called by shared::notify and shared::remove, with the map locked
+    static bool on_event(void * context, const shared::info_t<key_type> & info, const shared::event_t event) {
+        change_awaiter_t & self = *reinterpret_cast<change_awaiter_t *>(context);
+        
+        if(event == shared::VAR_CHANGED) {
+            const T & value = *shared::impl::info_to_data_ptr<T>(info);
+            
+            // Keep waiting
+            if(!self.predicate_(value)) return true;
+        }
+        else {
+            self.is_valid_ = false;
+        }
+        
+        // Unregister then resume
+        self.is_registered_ = false;
+        self.executor_->post(self.handle_);
+        return false;
+    }
+};
+
+// co_await shared::coro::changed<T>(map, key, executor)
+// resumes on the executor after the next shared::notify of the var.
+// Writes through views are plain memory writes and resume nothing:
+// the writer calls shared::notify, view.notify() or view.set_and_notify(value).
+template <shared::storable T, typename Map, typename Key = typename Map::key_type, shared::coro::executor Executor>
+inline auto changed(
+    Map & mp,
+    const std::type_identity_t<Key> & key,
+    Executor & ex
+) {
+    using awaiter_type = shared::coro::change_awaiter_t<T, Map, Executor, shared::coro::impl::any_change_t>;
+    return awaiter_type(mp, key, ex, shared::coro::impl::any_change_t());
+}
+
+// co_await shared::coro::changed(view, executor)
+template <typename View, shared::coro::executor Executor>
+inline auto changed(const View & view, Executor & ex) {
+    return shared::coro::changed<typename View::value_type>(*view.map(), view.key(), ex);
+}
+
+// co_await shared::coro::until<T>(map, key, predicate, executor)
+// resumes on the executor once "predicate(value)" is true.
+// The predicate is checked when waiting and on every shared::notify of the var,
+// plain writes through views are not seen (see shared::coro::changed).
+template <shared::storable T, typename Map, typename Key = typename Map::key_type, typename Predicate, shared::coro::executor Executor>
+inline auto until(
+    Map & mp,
+    const std::type_identity_t<Key> & key,
+    Predicate predicate,
+    Executor & ex
+) {
+    using awaiter_type = shared::coro::change_awaiter_t<T, Map, Executor, Predicate>;
+    return awaiter_type(mp, key, ex, std::move(predicate));
+}
+
+// co_await shared::coro::until(view, predicate, executor)
+template <typename View, typename Predicate, shared::coro::executor Executor>
+inline auto until(const View & view, Predicate predicate, Executor & ex) {
+    return shared::coro::until<typename View::value_type>(*view.map(), view.key(), std::move(predicate), ex);
+}
+
+} // namespace shared::coro
+
+
+#endif // SHARED_VAR_LIB__COROUTINES_HPP
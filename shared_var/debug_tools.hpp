@@ -32,17 +32,116 @@ limitations under the License.
 // std::string
 #include <string>
 
+// std::min and std::max
+#include <algorithm>
+
 // the lib
 #include "shared_var.hpp"
 
 // TODO:
-// - Improve print_map to use a function pointer from "info"
-//   created with the shared var, which converts the var to
-//   a string if it has a conversion function or member fn.
-//
 // - Comments
-//
-// - Returning a std::stringstream
+
+
+// Internal use
+namespace shared::debug::impl {
+
+// Keys dump can convert to text
+template <typename Key>
+concept printable_key = shared::impl::formattable<Key>;
+
+// Keys print_map can write without a formatter
+template <typename Key>
+concept streamable_key = requires (std::ostream & stream, const Key & key) {
+    stream << key;
+};
+
+// Appends a value converted by the var formatter
+template <typename Key>
+inline void append_value(std::string & out, const shared::info_t<Key> & info) {
+    if(info.ptr == nullptr) {
+        out += "[nullptr]";
+    }
+    else if(info.formatter != nullptr) {
+        info.formatter(out, info.ptr.get());
+    }
+    else {
+        out += "[unknown type]";
+    }
+}
+
+// Appends "text" right aligned to "width", like std::setw
+inline void append_padded(std::string & out, const std::string_view text, const std::size_t width) {
+    if(text.size() < width) {
+        out.append(width - text.size(), ' ');
+    }
+    
+    out += text;
+}
+
+inline void append_csv_field(std::string & out, const std::string_view text) {
+    if(text.find_first_of(",\"\r\n") == std::string_view::npos) {
+        out += text;
+        return;
+    }
+    
+    out += '"';
+    
+    for(const char c : text) {
+        if(c == '"') out += '"';
+        out += c;
+    }
+    
+    out += '"';
+}
+
+inline void append_json_string(std::string & out, const std::string_view text) {
+    static constexpr char hex[] = "0123456789abcdef";
+    
+    out += '"';
+    
+    for(const char c : text) {
+        switch(c) {
+            case '"':  out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\n': out += "\\n"; break;
+            case '\r': out += "\\r"; break;
+            case '\t': out += "\\t"; break;
+            default:
+                if(static_cast<unsigned char>(c) < 0x20) {
+                    out += "\\u00";
+                    out += hex[(c >> 4) & 0xF];
+                    out += hex[c & 0xF];
+                }
+                else {
+                    out += c;
+                }
+        }
+    }
+    
+    out += '"';
+}
+
+// Strings are quoted in the text format, like the old print_map did
+template <typename Key>
+inline bool is_string(const shared::info_t<Key> & info) {
+    const auto & type_id = *info.type_id;
+    
+    return
+        type_id == typeid(std::string) ||
+        type_id == typeid(const char *) ||
+        type_id == typeid(char *);
+}
+
+// Quotes the text of a string value, used by the text format
+template <typename Key>
+inline void quote_if_string(std::string & value_text, const shared::info_t<Key> & info) {
+    if(shared::debug::impl::is_string(info) && info.ptr != nullptr) {
+        value_text.insert(value_text.begin(), '"');
+        value_text += '"';
+    }
+}
+
+} // namespace shared::debug::impl
 
 
 namespace shared::debug {
@@ -94,69 +193,141 @@ bool is_type(const shared::info_t<Key> & info) {
         (type_id == typeid(const T));
 }
 
-// for each element in the map, print the key, value, group id and address
+// Output formats of shared::debug::dump
+enum dump_format_t : uint_fast8_t {
+    // Aligned columns: key, value, group, type and address
+    DUMP_TEXT       = 0,
+    // Header line, then key,value,group,type
+    DUMP_CSV        = 1,
+    // One {"key", "value", "group", "type"} object per line,
+    // every field is a JSON string
+    DUMP_JSON_LINES = 2
+};
+
+// Appends every var of the map to "out", one line per var.
+// The values are converted by the formatter of each var (see shared::info_t),
+// types without a conversion are written as "[unknown type]".
+// O(n): the text width is computed once, before the lines.
 template <typename Map, typename Key = typename Map::key_type>
-inline void print_map(Map & map, const std::string & comment = "") {
-    std::cout << comment << std::endl;
-    std::cout << "map at " << &map << std::endl;
-    for(auto & [key, info] : map) {
-        std::cout << 
-            std::setw(shared::debug::key_size(map, 12)) << 
-            key << ": ";
-        
-        std::cout << std::setw(14);
-        
-        if(     shared::debug::is_type<   uint8_t>(info)) 
-                shared::debug::print_info<uint8_t>(info);
-                
-        else if(shared::debug::is_type<   uint16_t>(info)) 
-                shared::debug::print_info<uint16_t>(info);
-        
-        else if(shared::debug::is_type<   uint32_t>(info)) 
-                shared::debug::print_info<uint32_t>(info);
-        
-        else if(shared::debug::is_type<   uint64_t>(info)) 
-                shared::debug::print_info<uint64_t>(info);
-        
-        else if(shared::debug::is_type<   int8_t>(info)) 
-                shared::debug::print_info<int8_t>(info);
-        
-        else if(shared::debug::is_type<   int16_t>(info)) 
-                shared::debug::print_info<int16_t>(info);
-        
-        else if(shared::debug::is_type<   int32_t>(info)) 
-                shared::debug::print_info<int32_t>(info);
-        
-        else if(shared::debug::is_type<   int64_t>(info)) 
-                shared::debug::print_info<int64_t>(info);
-        
-        else if(shared::debug::is_type<   float>(info)) 
-                shared::debug::print_info<float>(info);
-        
-        else if(shared::debug::is_type<   double>(info)) 
-                shared::debug::print_info<double>(info);
-        
-        else if(shared::debug::is_type<   char *>(info)) 
-                shared::debug::print_info<const char *>(info);
+requires shared::debug::impl::printable_key<Key>
+inline void dump(const Map & map, std::string & out, const shared::debug::dump_format_t format = shared::debug::DUMP_TEXT) {
+    // Reused for every field
+    std::string key_text;
+    std::string group_text;
+    std::string value_text;
+    
+    std::size_t key_width = 0;
+    
+    if(format == shared::debug::DUMP_TEXT) {
+        for(const auto & [key, info] : map) {
+            key_text.clear();
+            shared::impl::default_formatter<Key>(key_text, &key);
+            key_width = std::max(key_width, key_text.size());
+        }
         
-        else if(shared::debug::is_type<   const char *>(info)) 
-                shared::debug::print_info<const char *>(info);
+        key_width = std::min<std::size_t>(key_width, 12);
+    }
+    else if(format == shared::debug::DUMP_CSV) {
+        out += "key,value,group,type\n";
+    }
+    
+    for(const auto & [key, info] : map) {
+        key_text.clear();
+        group_text.clear();
+        value_text.clear();
         
-        else if(shared::debug::is_type<   std::string>(info)) 
-                shared::debug::print_info<std::string>(info);
+        shared::impl::default_formatter<Key>(key_text, &key);
+        shared::impl::default_formatter<Key>(group_text, &info.group_id);
+        shared::debug::impl::append_value(value_text, info);
         
+        if(format == shared::debug::DUMP_TEXT) {
+            shared::debug::impl::quote_if_string(value_text, info);
+            
+            shared::debug::impl::append_padded(out, key_text, key_width);
+            out += ": ";
+            shared::debug::impl::append_padded(out, value_text, 14);
+            out += " of group ";
+            out += group_text;
+            out += " and type ";
+            out += info.type_id->name();
+            out += " at ";
+            const void * address = info.ptr.get();
+            shared::impl::default_formatter<const void *>(out, &address);
+        }
+        else if(format == shared::debug::DUMP_CSV) {
+            shared::debug::impl::append_csv_field(out, key_text);
+            out += ',';
+            shared::debug::impl::append_csv_field(out, value_text);
+            out += ',';
+            shared::debug::impl::append_csv_field(out, group_text);
+            out += ',';
+            shared::debug::impl::append_csv_field(out, info.type_id->name());
+        }
         else {
-            std::cout << "[unknown type]";
+            out += "{\"key\":";
+            shared::debug::impl::append_json_string(out, key_text);
+            out += ",\"value\":";
+            shared::debug::impl::append_json_string(out, value_text);
+            out += ",\"group\":";
+            shared::debug::impl::append_json_string(out, group_text);
+            out += ",\"type\":";
+            shared::debug::impl::append_json_string(out, info.type_id->name());
+            out += '}';
         }
         
-        std::cout << 
-            " of group " << info.group_id << 
-            " and type " << info.type_id->name() <<
-            " at " << info.ptr << 
-            std::endl;
+        out += '\n';
     }
 }
 
+// Same as above, returning the text
+template <typename Map, typename Key = typename Map::key_type>
+requires shared::debug::impl::printable_key<Key>
+inline std::string dump(const Map & map, const shared::debug::dump_format_t format = shared::debug::DUMP_TEXT) {
+    std::string out;
+    shared::debug::dump(map, out, format);
+    return out;
+}
+
+// Same as above, writing to "stream" with a single write and no flush
+template <typename Map, typename Key = typename Map::key_type>
+requires shared::debug::impl::printable_key<Key>
+inline void dump(const Map & map, std::ostream & stream, const shared::debug::dump_format_t format = shared::debug::DUMP_TEXT) {
+    const std::string out = shared::debug::dump(map, format);
+    stream.write(out.data(), std::streamsize(out.size()));
+}
+
+// for each element in the map, print the key, value, group id and address
+template <typename Map, typename Key = typename Map::key_type>
+requires shared::debug::impl::printable_key<Key> || shared::debug::impl::streamable_key<Key>
+inline void print_map(Map & map, const std::string & comment = "") {
+    std::cout << comment << "\n";
+    std::cout << "map at " << &map << "\n";
+    
+    if constexpr(shared::debug::impl::printable_key<Key>) {
+        shared::debug::dump(map, std::cout, shared::debug::DUMP_TEXT);
+    }
+    else {
+        // Keys without a formatter are written by operator <<
+        std::string value_text;
+        
+        for(auto & [key, info] : map) {
+            value_text.clear();
+            shared::debug::impl::append_value(value_text, info);
+            shared::debug::impl::quote_if_string(value_text, info);
+            
+            std::cout << 
+                key << ": " << 
+                std::setw(14) << value_text << 
+                " of group " << info.group_id << 
+                " and type " << info.type_id->name() << 
+                " at " << info.ptr.get() << 
+                "\n";
+        }
+    }
+    
+    std::cout.flush();
+}
+
 } // namespace shared::debug
 
 
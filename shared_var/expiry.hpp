@@ -0,0 +1,196 @@
+#ifndef SHARED_VAR_LIB__EXPIRY_HPP
+#define SHARED_VAR_LIB__EXPIRY_HPP
+
+/* Shared Variable Library
+ * Expiry
+ * Author:  Yago T. de Mello
+ * e-mail:  yago.t.mello@gmail.com
+ * Version: 2.11.0 2022-07-09
+ * License: Apache 2.0
+ * C++20
+ */
+
+/*
+Copyright 2022 Yago Teodoro de Mello
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+    http://www.apache.org/licenses/LICENSE-2.0
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+// the timers are protected by a std::mutex
+#include <mutex>
+
+// the lib
+#include "shared_var.hpp"
+
+// expirations are scheduled on a timer wheel
+#include "timer_wheel.hpp"
+
+
+// module namespace
+namespace shared::expiry {
+
+// Removes vars after a time to live, with shared::remove.
+// Each expiration costs O(1) amortized, there is no scan of the map.
+// Time is counted in ticks (see shared::timer::timer_wheel_t), moved by advance().
+// Thread safe maps are locked once per expired var.
+template <typename Map, typename Key = typename Map::key_type>
+class expiry_t {
+public:
+    using key_type = Key;
+    using tick_type = shared::timer::timer_wheel_t::tick_type;
+    
+    explicit expiry_t(Map & mp) : map_(&mp) {
+        [[maybe_unused]] auto lock = shared::impl::lock_map(mp);
+        shared::observe_map(mp, &expiry_t::on_event, this);
+    }
+    
+    // The expiry address is the observer context, so it cannot move
+    expiry_t(const expiry_t &) = delete;
+    expiry_t & operator =(const expiry_t &) = delete;
+    
+    ~expiry_t() {
+        [[maybe_unused]] auto lock = shared::impl::lock_map(*map_);
+        shared::unobserve_map(*map_, &expiry_t::on_event, this);
+    }
+    
+    // Removes the var "ttl" ticks from now.
+    // Calling again restarts the time to live.
+    // Returns false if the var doesn't exist.
+    bool expire_after(const std::type_identity_t<Key> & key, const tick_type ttl) {
+        [[maybe_unused]] auto map_lock = shared::impl::lock_map(*map_);
+        
+        if(!map_->contains(key)) return false;
+        
+        std::scoped_lock lock(mutex_);
+        
+        auto [it, is_new] = entries_.try_emplace(key);
+        entry_t & entry = it->second;
+        
+        if(!is_new) {
+            wheel_.cancel(entry.timer);
+        }
+        
+        entry.owner = this;
+        entry.timer = wheel_.schedule(ttl, &expiry_t::on_timer, &*it);
+        return true;
+    }
+    
+    // The var will not expire anymore
+    void persist(const std::type_identity_t<Key> & key) {
+        std::scoped_lock lock(mutex_);
+        
+        auto it = entries_.find(key);
+        
+        if(it != entries_.end()) {
+            wheel_.cancel(it->second.timer);
+            entries_.erase(it);
+        }
+    }
+    
+    // True if the var has a time to live
+    bool expires(const std::type_identity_t<Key> & key) {
+        std::scoped_lock lock(mutex_);
+        return entries_.contains(key);
+    }
+    
+    // Moves the time "ticks" ticks forward and removes the expired vars.
+    // Returns how many vars were removed.
+    std::size_t advance(const tick_type ticks) {
+        std::vector<Key> expired;
+        
+        {
+            std::scoped_lock lock(mutex_);
+            expired_ = &expired;
+            wheel_.advance(ticks);
+            expired_ = nullptr;
+        }
+        
+        // The map is locked before the expiry, the same order as
+        // the observers fired by shared::thread_safe::remove
+        std::size_t removed = 0;
+        
+        for(const Key & key : expired) {
+            [[maybe_unused]] auto map_lock = shared::impl::lock_map(*map_);
+            
+            {
+                // expire_after was called again after the var expired
+                std::scoped_lock lock(mutex_);
+                if(entries_.contains(key)) continue;
+            }
+            
+            if(map_->contains(key)) {
+                shared::remove(*map_, key);
+                removed++;
+            }
+        }
+        
+        return removed;
+    }
+    
+    // Moves the time to "tick", if it is in the future
+    std::size_t advance_to(const tick_type tick) {
+        const tick_type now = this->now();
+        return tick > now ? this->advance(tick - now) : 0;
+    }
+    
+    // The current tick
+    tick_type now() {
+        std::scoped_lock lock(mutex_);
+        return wheel_.now();
+    }
+    
+    // How many vars have a time to live
+    std::size_t size() {
+        std::scoped_lock lock(mutex_);
+        return entries_.size();
+    }
+    
+private:
+    struct entry_t {
+        expiry_t * owner = nullptr;
+        shared::timer::timer_wheel_t::handle_t timer;
+    };
+    
+    using entry_map_type = std::map<Key, entry_t>;
+    
+    Map * map_;
+    std::mutex mutex_;
+    shared::timer::timer_wheel_t wheel_;
+    
+    // std::map nodes are stable, each node is the context of its timer
+    entry_map_type entries_;
+    
+    // Filled by the timers during advance()
+    std::vector<Key> * expired_ = nullptr;
+    
+    // Called by the wheel, with the mutex locked
+    static void on_timer(void * context) {
+        auto & node = *reinterpret_cast<typename entry_map_type::value_type *>(context);
+        expiry_t & self = *node.second.owner;
+        
+        self.expired_->push_back(node.first);
+        self.entries_.erase(self.expired_->back());
+    }
+    
+    // Vars removed by other means stop their timers.
+    // Called by shared::remove, with the map locked.
+    static bool on_event(void * context, const shared::info_t<Key> & info, const shared::event_t event) {
+        if(event == shared::VAR_REMOVED) {
+            reinterpret_cast<expiry_t *>(context)->persist(info.key);
+        }
+        
+        return true;
+    }
+};
+
+} // namespace shared::expiry
+
+
+#endif // SHARED_VAR_LIB__EXPIRY_HPP
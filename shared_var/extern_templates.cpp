@@ -0,0 +1,33 @@
+/* Shared Variable Library
+ * Extern templates
+ * Author:  Yago T. de Mello
+ * e-mail:  yago.t.mello@gmail.com
+ * Version: 2.11.0 2022-07-09
+ * License: Apache 2.0
+ * C++20
+ */
+
+/*
+Copyright 2022 Yago Teodoro de Mello
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+    http://www.apache.org/licenses/LICENSE-2.0
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+// Optional compiled part of the lib, see extern_templates.hpp.
+// Build it once and link it to the programs defining
+// SHARED_VAR_EXTERN_TEMPLATES.
+
+#include "shared_var.hpp"
+
+#include "multithread.hpp"
+
+SHARED_VAR_EXTERN_TEMPLATE_KEYS(SHARED_VAR_CORE_TEMPLATES, )
+
+SHARED_VAR_EXTERN_TEMPLATE_KEYS(SHARED_VAR_THREAD_SAFE_TEMPLATES, )
@@ -0,0 +1,108 @@
+#ifndef SHARED_VAR_LIB__EXTERN_TEMPLATES_HPP
+#define SHARED_VAR_LIB__EXTERN_TEMPLATES_HPP
+
+/* Shared Variable Library
+ * Extern templates
+ * Author:  Yago T. de Mello
+ * e-mail:  yago.t.mello@gmail.com
+ * Version: 2.11.0 2022-07-09
+ * License: Apache 2.0
+ * C++20
+ */
+
+/*
+Copyright 2022 Yago Teodoro de Mello
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+    http://www.apache.org/licenses/LICENSE-2.0
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+// The topology and snapshot machinery does not depend on the var types,
+// only on the key type. When SHARED_VAR_EXTERN_TEMPLATES is defined,
+// the instantiations for the common keys are declared extern and
+// every translation unit reuses the ones compiled in extern_templates.cpp.
+//
+// Included by shared_var.hpp and multithread.hpp, each part is declared
+// once the headers it depends on were included.
+// extern_templates.cpp must be built with the same macros
+// (e.g. SHARED_VAR_INSTRUMENTATION) as the code using it.
+
+// The keys instantiated by extern_templates.cpp,
+// "X" is called as X(EXTERN, Key)
+#define SHARED_VAR_EXTERN_TEMPLATE_KEYS(X, EXTERN) \
+    X(EXTERN, std::string) \
+    X(EXTERN, int) \
+    X(EXTERN, unsigned int) \
+    X(EXTERN, long) \
+    X(EXTERN, unsigned long) \
+    X(EXTERN, long long) \
+    X(EXTERN, unsigned long long)
+
+// Functions depending only on the key type
+#define SHARED_VAR_KEY_TEMPLATES(EXTERN, Key) \
+    EXTERN template void shared::impl::update_subscribers_var_ptr<Key>(shared::info_t<Key> &); \
+    EXTERN template void shared::impl::allocate_and_notify_subscribers<Key>(shared::info_t<Key> &, void *); \
+    EXTERN template bool shared::impl::take_group<Key>(shared::info_t<Key> &, const shared::info_t<Key> &); \
+    EXTERN template void shared::impl::link_vars<Key>(shared::info_t<Key> &, shared::info_t<Key> &); \
+    EXTERN template void shared::impl::fire_observers<Key>(std::vector<shared::observer_t<Key>> &, const shared::info_t<Key> &, shared::event_t); \
+    EXTERN template shared::info_t<Key> shared::impl::clone_info<Key>(const shared::info_t<Key> &);
+
+// Functions depending on the map type, used by both the
+// shared::var_map_t and shared::thread_safe::ts_var_map_t
+#define SHARED_VAR_MAP_TEMPLATES(EXTERN, Map, Key) \
+    EXTERN template void shared::impl::propagate_group<Map, Key>(Map &, shared::info_t<Key> &, const shared::info_t<Key> &); \
+    EXTERN template void shared::impl::autopropagate_group<Map, Key>(Map &, const shared::info_t<Key> &); \
+    EXTERN template void shared::impl::notify_observers<Map, Key>(Map &, shared::info_t<Key> &, shared::event_t); \
+    EXTERN template void shared::impl::detach_nodes<Map, Key>(Map &, shared::info_t<Key> &, bool); \
+    EXTERN template void shared::impl::remove<Map, Key>(Map &, shared::info_t<Key> &); \
+    EXTERN template shared::bind_t shared::bind<Map, Key>(Map &, const Key &, const Key &); \
+    EXTERN template void shared::unbind<Map, Key>(Map &, const Key &, const Key &); \
+    EXTERN template void shared::unbind_all<Map, Key>(Map &); \
+    EXTERN template void shared::remove<Map, Key>(Map &, const Key &); \
+    EXTERN template void shared::remove_all<Map, Key>(Map &); \
+    EXTERN template void shared::isolate<Map, Key>(Map &, const Key &); \
+    EXTERN template void shared::notify<Map, Key>(Map &, const Key &); \
+    EXTERN template std::vector<shared::info_t<Key>> shared::snapshot<Map, Key>(const Map &); \
+    EXTERN template void shared::restore<Map, Key>(Map &, std::vector<shared::info_t<Key>>);
+
+// Everything instantiated for shared::var_map_t<Key>
+#define SHARED_VAR_CORE_TEMPLATES(EXTERN, Key) \
+    EXTERN template class shared::var_map_t<Key>; \
+    SHARED_VAR_KEY_TEMPLATES(EXTERN, Key) \
+    SHARED_VAR_MAP_TEMPLATES(EXTERN, shared::var_map_t<Key>, Key)
+
+// Everything instantiated for shared::thread_safe::ts_var_map_t<Key>
+#define SHARED_VAR_THREAD_SAFE_TEMPLATES(EXTERN, Key) \
+    EXTERN template class shared::thread_safe::ts_var_map_t<Key>; \
+    SHARED_VAR_MAP_TEMPLATES(EXTERN, shared::thread_safe::ts_var_map_t<Key>, Key) \
+    EXTERN template shared::bind_t shared::thread_safe::bind<shared::thread_safe::ts_var_map_t<Key>, Key>(shared::thread_safe::ts_var_map_t<Key> &, const Key &, const Key &); \
+    EXTERN template void shared::thread_safe::unbind<shared::thread_safe::ts_var_map_t<Key>, Key>(shared::thread_safe::ts_var_map_t<Key> &, const Key &, const Key &); \
+    EXTERN template void shared::thread_safe::unbind_all<shared::thread_safe::ts_var_map_t<Key>, Key>(shared::thread_safe::ts_var_map_t<Key> &); \
+    EXTERN template void shared::thread_safe::remove<shared::thread_safe::ts_var_map_t<Key>, Key>(shared::thread_safe::ts_var_map_t<Key> &, const Key &); \
+    EXTERN template void shared::thread_safe::remove_all<shared::thread_safe::ts_var_map_t<Key>, Key>(shared::thread_safe::ts_var_map_t<Key> &); \
+    EXTERN template void shared::thread_safe::isolate<shared::thread_safe::ts_var_map_t<Key>, Key>(shared::thread_safe::ts_var_map_t<Key> &, const Key &); \
+    EXTERN template void shared::thread_safe::notify<shared::thread_safe::ts_var_map_t<Key>, Key>(shared::thread_safe::ts_var_map_t<Key> &, const Key &);
+
+#endif // SHARED_VAR_LIB__EXTERN_TEMPLATES_HPP
+
+
+#if defined(SHARED_VAR_EXTERN_TEMPLATES) && defined(SHARED_VAR_LIB__FUNCTIONS_HPP) && !defined(SHARED_VAR_LIB__EXTERN_TEMPLATES_CORE)
+#define SHARED_VAR_LIB__EXTERN_TEMPLATES_CORE
+
+SHARED_VAR_EXTERN_TEMPLATE_KEYS(SHARED_VAR_CORE_TEMPLATES, extern)
+
+#endif // SHARED_VAR_LIB__EXTERN_TEMPLATES_CORE
+
+
+#if defined(SHARED_VAR_EXTERN_TEMPLATES) && defined(SHARED_VAR_LIB__THREAD_SAFE_FUNCTIONS_HPP) && !defined(SHARED_VAR_LIB__EXTERN_TEMPLATES_THREAD_SAFE)
+#define SHARED_VAR_LIB__EXTERN_TEMPLATES_THREAD_SAFE
+
+SHARED_VAR_EXTERN_TEMPLATE_KEYS(SHARED_VAR_THREAD_SAFE_TEMPLATES, extern)
+
+#endif // SHARED_VAR_LIB__EXTERN_TEMPLATES_THREAD_SAFE
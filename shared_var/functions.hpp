@@ -50,6 +50,8 @@ inline shared::info_t<Key> * create(
     
     if(it == mp.end()) {
         // The var doesnt exist, lets create it
+        SHARED_VAR_COUNT(CREATES, 1);
+        SHARED_VAR_COUNT(ALLOCATIONS, 1);
         
         // The var info contains the shared var and
         // and the control variables
@@ -80,6 +82,8 @@ inline shared::info_t<Key> * create(
         info.ptr       = data_ptr;
         info.allocator = shared::impl::default_allocator<T>;
         info.copier    = shared::impl::default_copier<T>;
+        info.formatter = shared::impl::formatter_of<T>();
+        info.layout    = &shared::layout_of<T>;
         
         // Save the new var in the map of vars
         mp[key] = info;
@@ -140,6 +144,8 @@ inline shared::info_t<Key> * copy(
         info_dest.type_id   = info_src.type_id;
         info_dest.allocator = info_src.allocator;
         info_dest.copier    = info_src.copier;
+        info_dest.formatter = info_src.formatter;
+        info_dest.layout    = info_src.layout;
         
         // Setting some values that are different from the src
         info_dest.key = key_dest;
@@ -215,6 +221,8 @@ inline shared::bind_t bind(
     const std::type_identity_t<Key> & key_L, 
     const std::type_identity_t<Key> & key_R
 ) {
+    SHARED_VAR_COUNT(BINDS, 1);
+    
     // search for nodes
     auto it_key_L = mp.find(key_L);
     auto it_key_R = mp.find(key_R);
@@ -245,6 +253,12 @@ inline shared::bind_t bind(
         auto & info_L = shared::impl::iter_to_info<Map>(it_key_L);
         auto & info_R = shared::impl::iter_to_info<Map>(it_key_R);
         
+        // a var is always bound to itself, a self ref would
+        // be erased while iterated by detach_nodes
+        if(&info_L == &info_R) {
+            return shared::BIND_PROPAGATED_LHS_GROUP;
+        }
+        
         // check types
         if(shared::impl::are_types_equal(info_L, info_R)) {
             // both nodes exist and are of the same type, 
@@ -343,6 +357,11 @@ inline void remove(
 // Deletes every var in the map
 template <typename Map, typename Key = typename Map::key_type>
 inline void remove_all(Map & mp) {
+    // let the observers know the vars are going away
+    for(auto & [key, info] : mp) {
+        shared::impl::notify_observers(mp, info, shared::VAR_REMOVED);
+    }
+    
     mp.clear();
 }
 
@@ -365,6 +384,84 @@ inline void isolate(
     }
 }
 
+// Registers an observer of the var "key".
+// Returns false if the var doesn't exist.
+template <typename Map, typename Key = typename Map::key_type>
+inline bool observe(
+    Map & mp, 
+    const std::type_identity_t<Key> & key,
+    const typename shared::observer_t<Key>::callback_type callback,
+    void * context = nullptr
+) {
+    auto it = mp.find(key);
+    
+    if(it != mp.end()) {
+        shared::info_t<Key> & info = shared::impl::iter_to_info<Map>(it);
+        info.observers.push_back({callback, context});
+        return true;
+    }
+    else {
+        return false;
+    }
+}
+
+// Unregisters an observer of the var "key"
+template <typename Map, typename Key = typename Map::key_type>
+inline void unobserve(
+    Map & mp, 
+    const std::type_identity_t<Key> & key,
+    const typename shared::observer_t<Key>::callback_type callback,
+    void * context = nullptr
+) {
+    auto it = mp.find(key);
+    
+    if(it != mp.end()) {
+        shared::info_t<Key> & info = shared::impl::iter_to_info<Map>(it);
+        shared::impl::erase_observer(info.observers, callback, context);
+    }
+}
+
+// Registers an observer of every var in the map,
+// including vars created later
+template <typename Map, typename Key = typename Map::key_type>
+inline void observe_map(
+    Map & mp, 
+    const typename shared::observer_t<Key>::callback_type callback,
+    void * context = nullptr
+) {
+    mp.observers().push_back({callback, context});
+}
+
+// Unregisters an observer of every var in the map
+template <typename Map, typename Key = typename Map::key_type>
+inline void unobserve_map(
+    Map & mp, 
+    const typename shared::observer_t<Key>::callback_type callback,
+    void * context = nullptr
+) {
+    shared::impl::erase_observer(mp.observers(), callback, context);
+}
+
+// Tells the observers the var "key" has changed.
+// Every var in the group shares the memory, so every var is notified.
+template <typename Map, typename Key = typename Map::key_type>
+inline void notify(
+    Map & mp, 
+    const std::type_identity_t<Key> & key
+) {
+    SHARED_VAR_COUNT(LOOKUPS, 1);
+    SHARED_VAR_PROFILE_KEY(mp, key);
+    auto it = mp.find(key);
+    
+    if(it != mp.end()) {
+        shared::info_t<Key> & info = shared::impl::iter_to_info<Map>(it);
+        
+        shared::impl::for_each_in_group(mp, info, [&](shared::info_t<Key> & member) {
+            shared::impl::notify_observers(mp, member, shared::VAR_CHANGED);
+        });
+    }
+}
+
 enum exists_t : uint_fast8_t {
     VAR_DOESNT_EXIST,
     VAR_EXISTS_TYPES_ARE_DIFFERENT,
@@ -377,10 +474,12 @@ inline shared::exists_t exists(
     const Map & mp, 
     const std::type_identity_t<Key> & key
 ) {
+    SHARED_VAR_COUNT(LOOKUPS, 1);
+    SHARED_VAR_PROFILE_KEY(mp, key);
     auto it = mp.find(key);
     
     if(it != mp.end()) {
-        shared::info_t<Key> & info = shared::impl::iter_to_info<Map>(it);
+        const shared::info_t<Key> & info = shared::impl::iter_to_info<Map>(it);
         
         if(shared::impl::are_types_equal<T>(info)) {
             return shared::VAR_EXISTS_TYPES_ARE_EQUAL;
@@ -400,10 +499,12 @@ inline bool contains(
     const Map & mp, 
     const std::type_identity_t<Key> & key
 ) {
+    SHARED_VAR_COUNT(LOOKUPS, 1);
+    SHARED_VAR_PROFILE_KEY(mp, key);
     auto it = mp.find(key);
     
     if(it != mp.end()) {
-        shared::info_t<Key> & info = shared::impl::iter_to_info<Map>(it);
+        const shared::info_t<Key> & info = shared::impl::iter_to_info<Map>(it);
         
         if(shared::impl::are_types_equal<T>(info)) {
             return true;
@@ -423,6 +524,8 @@ inline bool contains_key(
     const Map & mp, 
     const std::type_identity_t<Key> & key
 ) {
+    SHARED_VAR_COUNT(LOOKUPS, 1);
+    SHARED_VAR_PROFILE_KEY(mp, key);
     return mp.contains(key);
 }
 
@@ -433,6 +536,8 @@ inline T * get_ptr(
     Map & mp, 
     const std::type_identity_t<Key> & key
 ) {
+    SHARED_VAR_COUNT(LOOKUPS, 1);
+    SHARED_VAR_PROFILE_KEY(mp, key);
     auto it = mp.find(key);
     
     // Check if the var exists
@@ -510,7 +615,10 @@ inline void set(
 // Creates a representation of the map to allow undo-ing changes.
 template <typename Map, typename Key = typename Map::key_type>
 inline std::vector<shared::info_t<Key>> snapshot(const Map & mp) {
-    std::vector<shared::info_t<Key>> data;//(mp.size());
+    SHARED_VAR_TIME_SCOPE(SNAPSHOT_NS);
+    
+    std::vector<shared::info_t<Key>> data;
+    data.reserve(mp.size());
     
     // Save the info to the data vector, with new storage and no subscribers
     for(const auto & [key, info] : mp) {
@@ -530,6 +638,8 @@ inline void restore(
     Map & mp, 
     std::vector<shared::info_t<Key>> data
 ) {
+    SHARED_VAR_TIME_SCOPE(RESTORE_NS);
+    
     // For every info saved to "data"
     for(shared::info_t<Key> & info_src : data) {
         // Check if exists a var with the same key in the new map
@@ -558,8 +668,10 @@ inline void restore(
         }
         else {
             // The var was removed!
-            // Lets re-create it
-            mp[info_src.key] = shared::impl::clone_info(info_src);
+            // Lets re-create it, alone in its group because the refs are not restored
+            shared::info_t<Key> & info_new = mp[info_src.key];
+            info_new = shared::impl::clone_info(info_src);
+            info_new.group_id = info_new.key;
         }
     }
 }
@@ -60,10 +60,73 @@ inline void default_copier(void * ptr_to_dest, void * ptr_to_src) {
     dest = src;
 }
 
+// Types shared::impl::default_formatter can convert to text
+template <typename T>
+concept formattable =
+    std::is_arithmetic_v<T> ||
+    std::is_pointer_v<T> ||
+    std::is_convertible_v<const T &, std::string_view> ||
+    requires (const T & value) { { value.to_string() } -> std::convertible_to<std::string_view>; } ||
+    requires (const T & value) { { to_string(value) } -> std::convertible_to<std::string_view>; };
+
+// Appends the value to "out", used by shared::debug::dump.
+// Numbers use std::to_chars, char and strings are appended unquoted.
+template <shared::storable T>
+inline void default_formatter(std::string & out, const void * ptr_to_value) {
+    const T & value = *reinterpret_cast<const T *>(ptr_to_value);
+    
+    if constexpr(std::is_same_v<T, bool>) {
+        out += value ? "true" : "false";
+    }
+    else if constexpr(std::is_same_v<T, char>) {
+        out += value;
+    }
+    else if constexpr(std::is_arithmetic_v<T>) {
+        char buffer[64];
+        auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+        out.append(buffer, result.ptr);
+    }
+    else if constexpr(std::is_convertible_v<const T &, std::string_view>) {
+        if constexpr(std::is_pointer_v<T>) {
+            if(value == nullptr) {
+                out += "[nullptr]";
+                return;
+            }
+        }
+        
+        out += std::string_view(value);
+    }
+    else if constexpr(std::is_pointer_v<T>) {
+        char buffer[2 + 2 * sizeof(void *)] = {'0', 'x'};
+        auto result = std::to_chars(buffer + 2, buffer + sizeof(buffer), reinterpret_cast<std::uintptr_t>(value), 16);
+        out.append(buffer, result.ptr);
+    }
+    else if constexpr(requires { { value.to_string() } -> std::convertible_to<std::string_view>; }) {
+        out += value.to_string();
+    }
+    else {
+        out += to_string(value);
+    }
+}
+
+// The formatter stored in shared::info_t, nullptr if the type is not formattable
+template <shared::storable T>
+inline constexpr auto formatter_of() -> void (*)(std::string & out, const void * ptr_to_value) {
+    using value_type = std::remove_cv_t<T>;
+    
+    if constexpr(shared::impl::formattable<value_type>) {
+        return &shared::impl::default_formatter<value_type>;
+    }
+    else {
+        return nullptr;
+    }
+}
+
 // Updates the subscribers to the new var address
 template <typename Key>
 inline void update_subscribers_var_ptr(shared::info_t<Key> & info) {
     void * new_ptr = info.ptr.get();
+    SHARED_VAR_COUNT(SUBSCRIBER_UPDATES, info.pointers_to_var.size());
     // For each subscriber, update the pointer address to 
     // point to the new var
     for(void ** ptr_to_var_ptr : info.pointers_to_var) {
@@ -75,6 +138,7 @@ inline void update_subscribers_var_ptr(shared::info_t<Key> & info) {
 template <typename Key>
 inline void allocate_and_notify_subscribers(shared::info_t<Key> & info, void * ptr_to_value) {
     // Allocate
+    SHARED_VAR_COUNT(ALLOCATIONS, 1);
     info.ptr = info.allocator(ptr_to_value);
     // Notify subscribers
     shared::impl::update_subscribers_var_ptr(info);
@@ -123,6 +187,8 @@ inline void make_reference(
     new_info.ptr       = var_info.ptr;
     new_info.allocator = var_info.allocator;
     new_info.copier    = var_info.copier;
+    new_info.formatter = var_info.formatter;
+    new_info.layout    = var_info.layout;
     
     // Link the new var to the input var
     new_info.refs.insert(var_info.key);
@@ -134,22 +200,49 @@ inline void make_reference(
     var_info.refs.insert(ref_name);
 }
 
+// Copies the group and data ptr of "src" to "dest", returns false
+// if "dest" already was in the group
+template <typename Key>
+inline bool take_group(shared::info_t<Key> & dest, const shared::info_t<Key> & src) {
+    SHARED_VAR_COUNT(PROPAGATIONS, 1);
+    
+    // Protect from cyclic references.
+    // The memory identifies the group: the ids are var keys and
+    // two groups may end up with the same id after unbinds
+    if(src.ptr == dest.ptr) return false;
+    
+    // Copy the group and data ptr
+    dest.group_id = src.group_id;
+    dest.ptr      = src.ptr;
+    
+    // Update dest subscribers to the new ptr
+    shared::impl::update_subscribers_var_ptr(dest);
+    
+    return true;
+}
+
 // Applies the source group to the dest group.
 // Faster than connecting two groups and autopropagating.
+// Iterative, so long chains don't overflow the stack.
 template <typename Map, typename Key = typename Map::key_type>
 inline void propagate_group(Map & mp, shared::info_t<Key> & dest, const shared::info_t<Key> & src) {
-    // Protect from cyclic references
-    if(src.group_id != dest.group_id) {
-        // Copy the group and data ptr
-        dest.group_id = src.group_id;
-        dest.ptr      = src.ptr;
-        
-        // Update dest subscribers to the new ptr
-        shared::impl::update_subscribers_var_ptr(dest);
+    if(!shared::impl::take_group(dest, src) || dest.refs.empty()) return;
+    
+    // Then repeat the process to every connected node, depth first
+    std::vector<shared::info_t<Key> *> pending;
+    
+    for(auto & key : dest.refs) {
+        pending.push_back(&mp[key]);
+    }
+    
+    while(!pending.empty()) {
+        shared::info_t<Key> & node = *pending.back();
+        pending.pop_back();
         
-        // Then repeat the process to every connected node
-        for(auto & key : dest.refs) {
-            shared::impl::propagate_group(mp, mp[key], src);
+        if(shared::impl::take_group(node, src)) {
+            for(auto & key : node.refs) {
+                pending.push_back(&mp[key]);
+            }
         }
     }
 }
@@ -171,6 +264,126 @@ inline void link_vars(shared::info_t<Key> & info1, shared::info_t<Key> & info2)
     info2.refs.insert(info1.key);
 }
 
+// An observer list detached by shared::impl::fire_observers.
+// The frames of a thread form a stack, observers may notify other vars.
+template <typename Key>
+struct dispatch_frame_t {
+    const std::vector<shared::observer_t<Key>> * list; // Where the observers are registered
+    std::vector<shared::observer_t<Key>> * current;    // The observers being called
+    dispatch_frame_t * previous;
+};
+
+// The innermost list being dispatched by this thread.
+// Observers are called with the map locked, so only this thread
+// may unregister them meanwhile.
+template <typename Key>
+inline thread_local shared::impl::dispatch_frame_t<Key> * dispatch_top = nullptr;
+
+// Unregisters the observer from the list, and from the calls
+// in progress if the list is being dispatched
+template <typename Key>
+inline void erase_observer(
+    std::vector<shared::observer_t<Key>> & observers,
+    const typename shared::observer_t<Key>::callback_type callback,
+    void * context
+) {
+    auto matches = [&](const shared::observer_t<Key> & observer) {
+        return observer.callback == callback && observer.context == context;
+    };
+    
+    std::erase_if(observers, matches);
+    
+    // Detached observers are marked dead (no callback),
+    // fire_observers drops them when merging back
+    for(auto * frame = shared::impl::dispatch_top<Key>; frame != nullptr; frame = frame->previous) {
+        if(frame->list != &observers) continue;
+        
+        for(shared::observer_t<Key> & observer : *frame->current) {
+            if(matches(observer)) observer.callback = nullptr;
+        }
+    }
+}
+
+// Calls every observer in the list, unregistering the ones returning false.
+// The list is detached while the observers are called, so new observers
+// may be registered by the callbacks, and observers unregistered by the
+// callbacks (shared::unobserve) are not called nor kept.
+template <typename Key>
+inline void fire_observers(
+    std::vector<shared::observer_t<Key>> & observers,
+    const shared::info_t<Key> & info,
+    const shared::event_t event
+) {
+    if(observers.empty()) return;
+    
+    std::vector<shared::observer_t<Key>> current;
+    current.swap(observers);
+    
+    // Pops the frame even if a callback throws
+    struct frame_guard_t {
+        shared::impl::dispatch_frame_t<Key> frame;
+        
+        ~frame_guard_t() {
+            shared::impl::dispatch_top<Key> = frame.previous;
+        }
+    } guard{{&observers, &current, shared::impl::dispatch_top<Key>}};
+    
+    shared::impl::dispatch_top<Key> = &guard.frame;
+    
+    // Indexes, the callbacks may mark any entry dead
+    for(std::size_t index = 0; index < current.size(); index++) {
+        const shared::observer_t<Key> observer = current[index];
+        if(observer.callback == nullptr) continue;
+        
+        if(!observer.callback(observer.context, info, event)) {
+            current[index].callback = nullptr;
+        }
+    }
+    
+    // Keep only the observers still interested
+    std::erase_if(current, [](const shared::observer_t<Key> & observer) {
+        return observer.callback == nullptr;
+    });
+    
+    // Observers registered during the calls go last
+    current.insert(current.end(), observers.begin(), observers.end());
+    observers.swap(current);
+}
+
+// Fires the var observers, then the map observers
+template <typename Map, typename Key = typename Map::key_type>
+inline void notify_observers(Map & mp, shared::info_t<Key> & info, const shared::event_t event) {
+    shared::impl::fire_observers(info.observers, info, event);
+    shared::impl::fire_observers(mp.observers(), info, event);
+}
+
+// Calls "function" for every var sharing memory with "info".
+// The group is collected before the first call.
+template <typename Map, typename Key = typename Map::key_type, typename Function>
+inline void for_each_in_group(Map & mp, shared::info_t<Key> & info, Function && function) {
+    // Most vars are not bound, skip the search
+    if(info.refs.empty()) {
+        function(info);
+        return;
+    }
+    
+    std::set<Key> visited = {info.key};
+    std::vector<shared::info_t<Key> *> group = {&info};
+    
+    // Breadth first search over the refs
+    for(std::size_t i = 0; i < group.size(); i++) {
+        for(const Key & ref_key : group[i]->refs) {
+            if(visited.insert(ref_key).second) {
+                group.push_back(&mp[ref_key]);
+            }
+        }
+    }
+    
+    for(shared::info_t<Key> * member : group) {
+        function(*member);
+    }
+}
+
 // Disconnect nodes from the selected node
 // If "should_remove_node" is "true", the selected node is removed.
 template <typename Map, typename Key = typename Map::key_type>
@@ -190,7 +403,7 @@ inline void detach_nodes(Map & mp, shared::info_t<Key> & info, const bool should
         if(ref.group_id == ref.key) {
             // do nothing, this branch is already solved
         }
-        else if(ref.group_id == info.group_id) {
+        else if(ref.ptr == info.ptr) {
             ref.group_id = ref.key;
             shared::impl::allocate_and_notify_subscribers(ref, ref.ptr.get());
             shared::impl::autopropagate_group(mp, ref);
@@ -219,6 +432,9 @@ inline void detach_nodes(Map & mp, shared::info_t<Key> & info, const bool should
 // Deletes a variable and removes its references from other variables
 template <typename Map, typename Key = typename Map::key_type>
 inline void remove(Map & mp, shared::info_t<Key> & info) {
+    // let the observers know the var is going away
+    shared::impl::notify_observers(mp, info, shared::VAR_REMOVED);
+    
     // remove references to this node then remove the node
     shared::impl::detach_nodes(mp, info, true);
 }
@@ -287,6 +503,8 @@ inline shared::info_t<Key> clone_info(
     new_info.key       = old_info.key;
     new_info.allocator = old_info.allocator;
     new_info.copier    = old_info.copier;
+    new_info.formatter = old_info.formatter;
+    new_info.layout    = old_info.layout;
     
     // Allocate new memory but keep the value
     shared::impl::allocate_and_notify_subscribers(new_info, old_info.ptr.get());
@@ -294,6 +512,31 @@ inline shared::info_t<Key> clone_info(
     return new_info;
 }
 
+// Placeholder lock for maps without a mutex
+struct no_lock_t {};
+
+// Locks thread safe maps for writing, does nothing for the others
+template <typename Map>
+inline auto lock_map(Map & mp) {
+    if constexpr(requires { typename Map::write_guard_type; }) {
+        return typename Map::write_guard_type(mp.mutex());
+    }
+    else {
+        return shared::impl::no_lock_t();
+    }
+}
+
+// Locks thread safe maps for reading, does nothing for the others
+template <typename Map>
+inline auto read_lock_map(const Map & mp) {
+    if constexpr(requires { typename Map::read_guard_type; }) {
+        return typename Map::read_guard_type(mp.mutex());
+    }
+    else {
+        return shared::impl::no_lock_t();
+    }
+}
+
 template <typename Key>
 inline void disconnect_subscribers(
     const shared::info_t<Key> & info
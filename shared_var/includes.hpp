@@ -29,6 +29,9 @@ limitations under the License.
 // enum bind_codes_t -> uint_fast8_t
 #include <cinttypes>
 
+// shared::impl::default_formatter -> std::to_chars
+#include <charconv>
+
 // concept std::convertible_to<T>
 #include <concepts>
 
@@ -47,6 +50,9 @@ limitations under the License.
 // Key -> std::string
 #include <string>
 
+// shared::impl::default_formatter accepts strings as std::string_view
+#include <string_view>
+
 // shared::info_t<Key>::type_id -> std::type_info
 #include <typeinfo>
 
@@ -59,4 +65,7 @@ limitations under the License.
 // snapshots are stored in a std::vector
 #include <vector>
 
+// SHARED_VAR_COUNT, empty unless SHARED_VAR_INSTRUMENTATION is defined
+#include "instrumentation.hpp"
+
 #endif // SHARED_VAR_LIB__INCLUDES_HPP
@@ -0,0 +1,481 @@
+#ifndef SHARED_VAR_LIB__INSTRUMENTATION_HPP
+#define SHARED_VAR_LIB__INSTRUMENTATION_HPP
+
+/* Shared Variable Library
+ * Instrumentation
+ * Author:  Yago T. de Mello
+ * e-mail:  yago.t.mello@gmail.com
+ * Version: 2.11.0 2022-07-09
+ * License: Apache 2.0
+ * C++20
+ */
+
+/*
+Copyright 2022 Yago Teodoro de Mello
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+    http://www.apache.org/licenses/LICENSE-2.0
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+// Counters and latency histograms of the library internals.
+// Define SHARED_VAR_INSTRUMENTATION before including the lib to enable them,
+// otherwise the SHARED_VAR_COUNT macro expands to nothing and the
+// thread safe maps use the plain std locks.
+// Every thread counts on its own data, read by shared::instrumentation::report().
+
+#ifdef SHARED_VAR_INSTRUMENTATION
+
+// std::min and std::max
+#include <algorithm>
+
+// std::array of counters and buckets
+#include <array>
+
+// the counters are read by other threads
+#include <atomic>
+
+// std::bit_width
+#include <bit>
+
+// lock times
+#include <chrono>
+
+// the thread data is registered in a global list
+#include <mutex>
+
+// std::vector
+#include <vector>
+
+
+// module namespace
+namespace shared::instrumentation {
+
+enum counter_t : uint_fast8_t {
+    LOOKUPS            = 0, // find by key: get_ptr, contains, exists
+    CREATES            = 1, // new vars
+    BINDS              = 2, // calls to shared::bind
+    PROPAGATIONS       = 3, // nodes visited while propagating groups
+    SUBSCRIBER_UPDATES = 4, // view pointers updated to a new var address
+    ALLOCATIONS        = 5, // var values allocated
+    LOCK_ACQUISITIONS  = 6, // thread safe map locks
+    LOCK_CONTENTIONS   = 7, // thread safe map locks that had to wait
+    COUNTER_COUNT      = 8
+};
+
+enum histogram_id_t : uint_fast8_t {
+    LOCK_WAIT_NS    = 0, // time waiting for a thread safe map lock
+    LOCK_HOLD_NS    = 1, // time holding a thread safe map lock
+    SNAPSHOT_NS     = 2, // time taking a snapshot
+    RESTORE_NS      = 3, // time restoring a snapshot
+    HISTOGRAM_COUNT = 4
+};
+
+// Log-linear buckets, like HDR histograms:
+// 16 buckets for each power of two, so the relative error is below 1/16.
+// Values below 16 have their own bucket.
+struct histogram_layout_t {
+    static constexpr unsigned sub_bucket_bits = 4;
+    static constexpr std::size_t sub_bucket_count = std::size_t(1) << sub_bucket_bits;
+    static constexpr std::size_t bucket_count = sub_bucket_count * (64 - sub_bucket_bits + 1);
+    
+    static constexpr std::size_t index_of(const std::uint64_t value) {
+        if(value < sub_bucket_count) return std::size_t(value);
+        
+        const unsigned exponent = unsigned(std::bit_width(value)) - 1;
+        const unsigned shift = exponent - sub_bucket_bits;
+        const std::size_t sub_bucket = std::size_t(value >> shift) & (sub_bucket_count - 1);
+        
+        return sub_bucket_count * (shift + 1) + sub_bucket;
+    }
+    
+    // The smallest value of the bucket
+    static constexpr std::uint64_t value_of(const std::size_t index) {
+        if(index < sub_bucket_count) return index;
+        
+        const unsigned shift = unsigned(index / sub_bucket_count) - 1;
+        const std::uint64_t sub_bucket = index % sub_bucket_count;
+        
+        return (sub_bucket_count + sub_bucket) << shift;
+    }
+};
+
+// A histogram read by shared::instrumentation::report()
+class histogram_t {
+public:
+    void add(const std::uint64_t value, const std::uint64_t times = 1) {
+        counts_[histogram_layout_t::index_of(value)] += times;
+        count_ += times;
+        sum_ += value * times;
+        max_ = std::max(max_, value);
+    }
+    
+    void add_bucket(const std::size_t index, const std::uint64_t times) {
+        counts_[index] += times;
+        count_ += times;
+    }
+    
+    void merge_max(const std::uint64_t max) {
+        max_ = std::max(max_, max);
+    }
+    
+    // add_bucket doesn't know the values, the exact sum is merged apart
+    void merge_sum(const std::uint64_t sum) {
+        sum_ += sum;
+    }
+    
+    // The value below which "percentile"% of the values are,
+    // "percentile" is in [0, 100].
+    // Returns the highest value of the bucket, like HDR histograms.
+    std::uint64_t percentile(const double percentile) const {
+        if(count_ == 0) return 0;
+        
+        const double target = percentile / 100.0 * double(count_);
+        std::uint64_t seen = 0;
+        
+        for(std::size_t i = 0; i < counts_.size(); i++) {
+            seen += counts_[i];
+            
+            if(counts_[i] != 0 && double(seen) >= target) {
+                return std::min(histogram_layout_t::value_of(i + 1) - 1, max_);
+            }
+        }
+        
+        return max_;
+    }
+    
+    std::uint64_t count() const {
+        return count_;
+    }
+    
+    std::uint64_t max() const {
+        return max_;
+    }
+    
+    // Sum of every value added
+    std::uint64_t sum() const {
+        return sum_;
+    }
+    
+    std::uint64_t bucket(const std::size_t index) const {
+        return counts_[index];
+    }
+    
+private:
+    std::array<std::uint64_t, histogram_layout_t::bucket_count> counts_ = {};
+    std::uint64_t count_ = 0;
+    std::uint64_t sum_ = 0;
+    std::uint64_t max_ = 0;
+};
+
+// Called by the lookups of a map with a key profiler,
+// for one in "sample_period" lookups and for every lookup
+// that waited for the map lock
+template <typename Key>
+struct lookup_hook_t {
+    using callback_type = void (*)(void * context, const Key & key, bool is_sample, bool was_contended);
+    
+    callback_type callback = nullptr;
+    void * context = nullptr;
+    std::uint32_t sample_period = 64;
+};
+
+// Sum of every thread
+struct report_t {
+    std::array<std::uint64_t, shared::instrumentation::COUNTER_COUNT> counters = {};
+    std::array<shared::instrumentation::histogram_t, shared::instrumentation::HISTOGRAM_COUNT> histograms;
+    
+    std::uint64_t operator [](const shared::instrumentation::counter_t counter) const {
+        return counters[counter];
+    }
+    
+    const shared::instrumentation::histogram_t & operator [](const shared::instrumentation::histogram_id_t id) const {
+        return histograms[id];
+    }
+};
+
+} // namespace shared::instrumentation
+
+
+// Internal use
+namespace shared::instrumentation::impl {
+
+// Written only by its thread, read by any thread.
+// Relaxed loads and stores, without atomic read-modify-write.
+struct thread_data_t {
+    std::array<std::atomic<std::uint64_t>, shared::instrumentation::COUNTER_COUNT> counters = {};
+    
+    struct histogram_data_t {
+        std::array<std::atomic<std::uint64_t>, shared::instrumentation::histogram_layout_t::bucket_count> counts = {};
+        std::atomic<std::uint64_t> sum = 0;
+        std::atomic<std::uint64_t> max = 0;
+    };
+    
+    std::array<histogram_data_t, shared::instrumentation::HISTOGRAM_COUNT> histograms;
+    
+    // Only used by the thread, to sample the lookups
+    std::uint32_t sample_countdown = 1;
+    std::uint32_t sample_seed = 0x9E3779B9u;
+    
+    // The last map lock of the thread had to wait,
+    // the next lookup gets the contention
+    bool lock_contended = false;
+    
+    static void bump(std::atomic<std::uint64_t> & value, const std::uint64_t n) {
+        value.store(value.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+    }
+    
+    void count(const shared::instrumentation::counter_t counter, const std::uint64_t n) {
+        bump(counters[counter], n);
+    }
+    
+    void record(const shared::instrumentation::histogram_id_t id, const std::uint64_t value) {
+        histogram_data_t & histogram = histograms[id];
+        bump(histogram.counts[shared::instrumentation::histogram_layout_t::index_of(value)], 1);
+        bump(histogram.sum, value);
+        
+        if(value > histogram.max.load(std::memory_order_relaxed)) {
+            histogram.max.store(value, std::memory_order_relaxed);
+        }
+    }
+    
+    void add_to(shared::instrumentation::report_t & report) const {
+        for(std::size_t i = 0; i < counters.size(); i++) {
+            report.counters[i] += counters[i].load(std::memory_order_relaxed);
+        }
+        
+        for(std::size_t id = 0; id < histograms.size(); id++) {
+            for(std::size_t i = 0; i < histograms[id].counts.size(); i++) {
+                const std::uint64_t times = histograms[id].counts[i].load(std::memory_order_relaxed);
+                if(times != 0) report.histograms[id].add_bucket(i, times);
+            }
+            
+            report.histograms[id].merge_sum(histograms[id].sum.load(std::memory_order_relaxed));
+            report.histograms[id].merge_max(histograms[id].max.load(std::memory_order_relaxed));
+        }
+    }
+    
+    void clear() {
+        for(auto & counter : counters) {
+            counter.store(0, std::memory_order_relaxed);
+        }
+        
+        for(auto & histogram : histograms) {
+            for(auto & bucket : histogram.counts) {
+                bucket.store(0, std::memory_order_relaxed);
+            }
+            
+            histogram.sum.store(0, std::memory_order_relaxed);
+            histogram.max.store(0, std::memory_order_relaxed);
+        }
+    }
+};
+
+// Every live thread, plus the data of the threads that exited
+struct registry_t {
+    std::mutex mutex;
+    std::vector<shared::instrumentation::impl::thread_data_t *> threads;
+    shared::instrumentation::report_t retired;
+    
+    static registry_t & instance() {
+        static registry_t registry;
+        return registry;
+    }
+};
+
+// Registers the thread data on the first use, merges it into
+// the retired data when the thread exits
+class thread_slot_t {
+public:
+    thread_slot_t() {
+        auto & registry = shared::instrumentation::impl::registry_t::instance();
+        std::scoped_lock lock(registry.mutex);
+        registry.threads.push_back(&data_);
+    }
+    
+    ~thread_slot_t() {
+        auto & registry = shared::instrumentation::impl::registry_t::instance();
+        std::scoped_lock lock(registry.mutex);
+        
+        data_.add_to(registry.retired);
+        std::erase(registry.threads, &data_);
+    }
+    
+    shared::instrumentation::impl::thread_data_t & data() {
+        return data_;
+    }
+    
+private:
+    shared::instrumentation::impl::thread_data_t data_;
+};
+
+inline shared::instrumentation::impl::thread_data_t & local() {
+    thread_local shared::instrumentation::impl::thread_slot_t slot;
+    return slot.data();
+}
+
+// Calls the lookup hook of the map, if any
+template <typename Map, typename Key>
+inline void profile_key(const Map & mp, const Key & key) {
+    if constexpr(requires { mp.lookup_hook(); }) {
+        const auto & hook = mp.lookup_hook();
+        if(hook.callback == nullptr) return;
+        
+        auto & data = shared::instrumentation::impl::local();
+        const bool was_contended = std::exchange(data.lock_contended, false);
+        const bool is_sample = --data.sample_countdown == 0;
+        
+        // The next sample is 1 to 2 * period - 1 lookups away, the jitter
+        // prevents aliasing with periodic access patterns
+        if(is_sample) {
+            data.sample_seed ^= data.sample_seed << 13;
+            data.sample_seed ^= data.sample_seed >> 17;
+            data.sample_seed ^= data.sample_seed << 5;
+            
+            const std::uint32_t period = hook.sample_period > 0 ? hook.sample_period : 1;
+            data.sample_countdown = 1 + data.sample_seed % (2 * period - 1);
+        }
+        
+        if(is_sample || was_contended) {
+            hook.callback(hook.context, key, is_sample, was_contended);
+        }
+    }
+}
+
+} // namespace shared::instrumentation::impl
+
+
+// module namespace
+namespace shared::instrumentation {
+
+// Sums the data of every thread
+inline shared::instrumentation::report_t report() {
+    auto & registry = shared::instrumentation::impl::registry_t::instance();
+    std::scoped_lock lock(registry.mutex);
+    
+    shared::instrumentation::report_t result = registry.retired;
+    
+    for(const auto * data : registry.threads) {
+        data->add_to(result);
+    }
+    
+    return result;
+}
+
+// Clears the data of every thread.
+// Racy with threads counting at the same time, a few counts may survive.
+inline void reset() {
+    auto & registry = shared::instrumentation::impl::registry_t::instance();
+    std::scoped_lock lock(registry.mutex);
+    
+    registry.retired = shared::instrumentation::report_t();
+    
+    for(auto * data : registry.threads) {
+        data->clear();
+    }
+}
+
+// Lock guard measuring the wait and hold times,
+// used as the guard types of the thread safe maps
+template <typename Lock>
+class timed_lock_t {
+public:
+    using clock_type = std::chrono::steady_clock;
+    using mutex_type = typename Lock::mutex_type;
+    
+    explicit timed_lock_t(mutex_type & mutex) {
+        const auto start = clock_type::now();
+        lock_ = Lock(mutex, std::try_to_lock);
+        
+        const bool was_contended = !lock_.owns_lock();
+        
+        if(was_contended) {
+            lock_.lock();
+        }
+        
+        acquired_ = clock_type::now();
+        
+        auto & data = shared::instrumentation::impl::local();
+        data.lock_contended = was_contended;
+        data.count(shared::instrumentation::LOCK_ACQUISITIONS, 1);
+        data.count(shared::instrumentation::LOCK_CONTENTIONS, was_contended ? 1 : 0);
+        data.record(shared::instrumentation::LOCK_WAIT_NS, nanoseconds(acquired_ - start));
+    }
+    
+    timed_lock_t(const timed_lock_t &) = delete;
+    timed_lock_t & operator =(const timed_lock_t &) = delete;
+    
+    ~timed_lock_t() {
+        if(lock_.owns_lock()) {
+            const auto held = clock_type::now() - acquired_;
+            lock_.unlock();
+            
+            auto & data = shared::instrumentation::impl::local();
+            data.lock_contended = false;
+            data.record(shared::instrumentation::LOCK_HOLD_NS, nanoseconds(held));
+        }
+    }
+    
+private:
+    Lock lock_;
+    clock_type::time_point acquired_;
+    
+    static std::uint64_t nanoseconds(const clock_type::duration duration) {
+        return std::uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count());
+    }
+};
+
+// Records the lifetime of the timer in a histogram
+class scoped_timer_t {
+public:
+    using clock_type = std::chrono::steady_clock;
+    
+    explicit scoped_timer_t(const shared::instrumentation::histogram_id_t id) :
+        id_(id),
+        start_(clock_type::now())
+    {}
+    
+    scoped_timer_t(const scoped_timer_t &) = delete;
+    scoped_timer_t & operator =(const scoped_timer_t &) = delete;
+    
+    ~scoped_timer_t() {
+        const auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(clock_type::now() - start_);
+        shared::instrumentation::impl::local().record(id_, std::uint64_t(elapsed.count()));
+    }
+    
+private:
+    shared::instrumentation::histogram_id_t id_;
+    clock_type::time_point start_;
+};
+
+} // namespace shared::instrumentation
+
+
+// Adds "n" to the counter shared::instrumentation::"counter" of this thread
+#define SHARED_VAR_COUNT(counter, n) \
+    shared::instrumentation::impl::local().count(shared::instrumentation::counter, (n))
+
+// Reports the lookup of "key" to the key profiler of "mp"
+#define SHARED_VAR_PROFILE_KEY(mp, key) \
+    shared::instrumentation::impl::profile_key((mp), (key))
+
+// Records the time until the end of the scope in the histogram
+// shared::instrumentation::"histogram" of this thread
+#define SHARED_VAR_TIME_SCOPE(histogram) \
+    shared::instrumentation::scoped_timer_t shared_var_scoped_timer_(shared::instrumentation::histogram)
+
+#else
+
+#define SHARED_VAR_COUNT(counter, n) ((void)0)
+#define SHARED_VAR_PROFILE_KEY(mp, key) ((void)0)
+#define SHARED_VAR_TIME_SCOPE(histogram) ((void)0)
+
+#endif // SHARED_VAR_INSTRUMENTATION
+
+
+#endif // SHARED_VAR_LIB__INSTRUMENTATION_HPP
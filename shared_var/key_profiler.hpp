@@ -0,0 +1,252 @@
+#ifndef SHARED_VAR_LIB__KEY_PROFILER_HPP
+#define SHARED_VAR_LIB__KEY_PROFILER_HPP
+
+/* Shared Variable Library
+ * Key profiler
+ * Author:  Yago T. de Mello
+ * e-mail:  yago.t.mello@gmail.com
+ * Version: 2.11.0 2022-07-09
+ * License: Apache 2.0
+ * C++20
+ */
+
+/*
+Copyright 2022 Yago Teodoro de Mello
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+    http://www.apache.org/licenses/LICENSE-2.0
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+// Requires SHARED_VAR_INSTRUMENTATION, the lookups call the profiler
+// through shared::instrumentation::lookup_hook_t
+
+// the sketch rows -> std::array
+#include <array>
+
+// std::sort
+#include <algorithm>
+
+// the sketch counters are updated by many threads
+#include <atomic>
+
+// std::hash
+#include <functional>
+
+// the top keys are protected by a std::mutex
+#include <mutex>
+
+// the lib
+#include "shared_var.hpp"
+
+#ifndef SHARED_VAR_INSTRUMENTATION
+#error "shared_var/key_profiler.hpp requires SHARED_VAR_INSTRUMENTATION"
+#endif
+
+
+// Internal use
+namespace shared::instrumentation::impl {
+
+// Count-min sketch: estimates how many times each key was added,
+// never below the real count, with fixed memory
+class count_min_sketch_t {
+public:
+    static constexpr std::size_t depth = 4;
+    static constexpr std::size_t width = 4096;
+    
+    // Returns the new estimate
+    std::uint64_t add(const std::size_t hash) {
+        std::uint64_t estimate = ~std::uint64_t(0);
+        
+        for(std::size_t row = 0; row < depth; row++) {
+            const std::uint64_t count = rows_[row][index(hash, row)].fetch_add(1, std::memory_order_relaxed) + 1;
+            estimate = std::min(estimate, count);
+        }
+        
+        return estimate;
+    }
+    
+    std::uint64_t estimate(const std::size_t hash) const {
+        std::uint64_t estimate = ~std::uint64_t(0);
+        
+        for(std::size_t row = 0; row < depth; row++) {
+            estimate = std::min(estimate, rows_[row][index(hash, row)].load(std::memory_order_relaxed));
+        }
+        
+        return estimate;
+    }
+    
+private:
+    std::array<std::array<std::atomic<std::uint64_t>, width>, depth> rows_ = {};
+    
+    // A different mix of the hash for each row (splitmix64 finalizer)
+    static std::size_t index(const std::size_t hash, const std::size_t row) {
+        std::uint64_t x = std::uint64_t(hash) + 0x9E3779B97F4A7C15ull * (row + 1);
+        x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+        x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+        x = x ^ (x >> 31);
+        return std::size_t(x % width);
+    }
+};
+
+} // namespace shared::instrumentation::impl
+
+
+// module namespace
+namespace shared::instrumentation {
+
+// A key of the report
+template <typename Key>
+struct hot_key_t {
+    Key key;
+    
+    // Estimated lookups, the sampled count times the sample period
+    std::uint64_t accesses;
+    
+    // Lookups that waited for the thread safe map lock
+    std::uint64_t contentions;
+};
+
+// Finds the most used keys of a map by sampling its lookups.
+// One in "sample_period" lookups of each thread is counted in a
+// count-min sketch, the keys with the highest counts are kept as candidates.
+// Lookups that waited for the map lock are always counted.
+// Attached on construction, detached on destruction.
+template <typename Map, typename Key = typename Map::key_type>
+class key_profiler_t {
+public:
+    using key_type = Key;
+    
+    explicit key_profiler_t(Map & mp, const std::size_t top_k = 16, const std::uint32_t sample_period = 64) :
+        map_(&mp),
+        top_k_(top_k),
+        sample_period_(std::max<std::uint32_t>(sample_period, 1))
+    {
+        [[maybe_unused]] auto lock = shared::impl::lock_map(mp);
+        mp.lookup_hook() = {&key_profiler_t::on_lookup, this, sample_period_};
+    }
+    
+    // The address is the hook context, so it cannot move
+    key_profiler_t(const key_profiler_t &) = delete;
+    key_profiler_t & operator =(const key_profiler_t &) = delete;
+    
+    ~key_profiler_t() {
+        [[maybe_unused]] auto lock = shared::impl::lock_map(*map_);
+        map_->lookup_hook() = {};
+    }
+    
+    // The most accessed keys, most accessed first
+    std::vector<shared::instrumentation::hot_key_t<Key>> top() const {
+        return this->report(accesses_, hot_);
+    }
+    
+    // The keys that most waited for the map lock, most contended first
+    std::vector<shared::instrumentation::hot_key_t<Key>> top_contended() const {
+        return this->report(contentions_, contended_);
+    }
+    
+    // Estimated lookups of "key"
+    std::uint64_t accesses(const Key & key) const {
+        return accesses_.estimate(std::hash<Key>()(key)) * sample_period_;
+    }
+    
+    // Estimated lookups of "key" that waited for the map lock
+    std::uint64_t contentions(const Key & key) const {
+        return contentions_.estimate(std::hash<Key>()(key));
+    }
+    
+private:
+    struct candidate_t {
+        Key key;
+        std::uint64_t count;
+    };
+    
+    Map * map_;
+    std::size_t top_k_;
+    std::uint32_t sample_period_;
+    
+    shared::instrumentation::impl::count_min_sketch_t accesses_;
+    shared::instrumentation::impl::count_min_sketch_t contentions_;
+    
+    // Candidates for the top keys, 4 times top_k to tolerate the sampling noise
+    mutable std::mutex mutex_;
+    std::vector<candidate_t> hot_;
+    std::vector<candidate_t> contended_;
+    
+    // Keeps the "capacity" keys with the highest counts
+    void offer(std::vector<candidate_t> & candidates, const Key & key, const std::uint64_t count) {
+        std::scoped_lock lock(mutex_);
+        
+        const std::size_t capacity = 4 * top_k_;
+        candidate_t * lowest = nullptr;
+        
+        for(candidate_t & candidate : candidates) {
+            if(candidate.key == key) {
+                candidate.count = count;
+                return;
+            }
+            
+            if(lowest == nullptr || candidate.count < lowest->count) {
+                lowest = &candidate;
+            }
+        }
+        
+        if(candidates.size() < capacity) {
+            candidates.push_back({key, count});
+        }
+        else if(lowest != nullptr && lowest->count < count) {
+            *lowest = {key, count};
+        }
+    }
+    
+    std::vector<shared::instrumentation::hot_key_t<Key>> report(
+        const shared::instrumentation::impl::count_min_sketch_t & sketch,
+        const std::vector<candidate_t> & candidates
+    ) const {
+        std::vector<shared::instrumentation::hot_key_t<Key>> result;
+        
+        {
+            std::scoped_lock lock(mutex_);
+            
+            for(const candidate_t & candidate : candidates) {
+                result.push_back({candidate.key, this->accesses(candidate.key), this->contentions(candidate.key)});
+            }
+        }
+        
+        const bool by_accesses = &sketch == &accesses_;
+        
+        std::sort(result.begin(), result.end(), [by_accesses](const auto & lhs, const auto & rhs) {
+            return by_accesses ? lhs.accesses > rhs.accesses : lhs.contentions > rhs.contentions;
+        });
+        
+        if(result.size() > top_k_) {
+            result.resize(top_k_);
+        }
+        
+        return result;
+    }
+    
+    // Called by the lookups, see shared::instrumentation::lookup_hook_t
+    static void on_lookup(void * context, const Key & key, const bool is_sample, const bool was_contended) {
+        key_profiler_t & self = *reinterpret_cast<key_profiler_t *>(context);
+        const std::size_t hash = std::hash<Key>()(key);
+        
+        if(is_sample) {
+            self.offer(self.hot_, key, self.accesses_.add(hash));
+        }
+        
+        if(was_contended) {
+            self.offer(self.contended_, key, self.contentions_.add(hash));
+        }
+    }
+};
+
+} // namespace shared::instrumentation
+
+
+#endif // SHARED_VAR_LIB__KEY_PROFILER_HPP
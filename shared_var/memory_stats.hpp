@@ -0,0 +1,258 @@
+#ifndef SHARED_VAR_LIB__MEMORY_STATS_HPP
+#define SHARED_VAR_LIB__MEMORY_STATS_HPP
+
+/* Shared Variable Library
+ * Memory stats
+ * Author:  Yago T. de Mello
+ * e-mail:  yago.t.mello@gmail.com
+ * Version: 2.11.0 2022-07-09
+ * License: Apache 2.0
+ * C++20
+ */
+
+/*
+Copyright 2022 Yago Teodoro de Mello
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+    http://www.apache.org/licenses/LICENSE-2.0
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+// the values shared by a group are counted once
+#include <unordered_map>
+#include <unordered_set>
+
+// the lib
+#include "shared_var.hpp"
+
+
+// module namespace
+namespace shared::memory {
+
+// Bytes used by a map, by category.
+// Estimates: the tree nodes and control blocks use the libstdc++/libc++ layouts,
+// the malloc headers and the heap owned by the values (like std::string values)
+// are not counted.
+struct stats_t {
+    std::size_t vars = 0;
+    std::size_t groups = 0;
+    
+    // Map keys, var keys, group ids and refs, including their heap buffers
+    std::size_t keys = 0;
+    
+    // Map nodes and shared::info_t, without the keys
+    std::size_t metadata = 0;
+    
+    // Values and their shared_ptr control blocks, once per group
+    std::size_t values = 0;
+    
+    // Nodes of shared::info_t::refs
+    std::size_t adjacency = 0;
+    
+    // Nodes of shared::info_t::pointers_to_var and the observers
+    std::size_t subscribers = 0;
+    
+    std::size_t total() const {
+        return keys + metadata + values + adjacency + subscribers;
+    }
+    
+    stats_t & operator +=(const stats_t & rhs) {
+        vars        += rhs.vars;
+        groups      += rhs.groups;
+        keys        += rhs.keys;
+        metadata    += rhs.metadata;
+        values      += rhs.values;
+        adjacency   += rhs.adjacency;
+        subscribers += rhs.subscribers;
+        return *this;
+    }
+};
+
+// The bytes used by a group, groups may share the id
+template <typename Key>
+struct group_stats_t {
+    Key group_id;
+    shared::memory::stats_t stats;
+};
+
+} // namespace shared::memory
+
+
+// Internal use
+namespace shared::memory::impl {
+
+// Color, parent, left and right of a red-black tree node
+inline constexpr std::size_t tree_node_overhead = 4 * sizeof(void *);
+
+// Vtable, use count and weak count of a std::make_shared control block
+inline constexpr std::size_t control_block_overhead = sizeof(void *) + 2 * sizeof(int);
+
+// The key and its heap buffer, if it is not stored inside the key
+// (small string optimization)
+template <typename Key>
+inline std::size_t key_bytes(const Key & key) {
+    std::size_t bytes = sizeof(Key);
+    
+    if constexpr(requires { key.capacity(); key.data(); typename Key::value_type; }) {
+        const auto * data = reinterpret_cast<const std::byte *>(key.data());
+        const auto * self = reinterpret_cast<const std::byte *>(&key);
+        
+        if(data < self || data >= self + sizeof(Key)) {
+            bytes += (key.capacity() + 1) * sizeof(typename Key::value_type);
+        }
+    }
+    
+    return bytes;
+}
+
+// Adds a var to the stats, "seen" has the values already counted
+template <typename Key>
+inline void accumulate(
+    shared::memory::stats_t & stats,
+    const shared::info_t<Key> & info,
+    std::unordered_set<const void *> & seen
+) {
+    stats.vars++;
+    
+    // Map key, var key and group id
+    stats.keys += 3 * shared::memory::impl::key_bytes(info.key);
+    stats.metadata += shared::memory::impl::tree_node_overhead + sizeof(shared::info_t<Key>) - 2 * sizeof(Key);
+    
+    for(const Key & ref : info.refs) {
+        stats.keys += shared::memory::impl::key_bytes(ref);
+        stats.adjacency += shared::memory::impl::tree_node_overhead;
+    }
+    
+    stats.subscribers += info.pointers_to_var.size() * (shared::memory::impl::tree_node_overhead + sizeof(void **));
+    stats.subscribers += info.observers.capacity() * sizeof(shared::observer_t<Key>);
+    
+    // The group members share the value
+    if(info.ptr != nullptr && seen.insert(info.ptr.get()).second) {
+        stats.groups++;
+        stats.values += shared::memory::impl::control_block_overhead;
+        
+        if(info.layout != nullptr) {
+            stats.values += info.layout->size;
+        }
+    }
+}
+
+} // namespace shared::memory::impl
+
+
+// module namespace
+namespace shared::memory {
+
+// Bytes used by the whole map. O(n).
+template <typename Map, typename Key = typename Map::key_type>
+inline shared::memory::stats_t memory_stats(const Map & mp) {
+    [[maybe_unused]] auto lock = shared::impl::read_lock_map(mp);
+    
+    shared::memory::stats_t stats;
+    std::unordered_set<const void *> seen;
+    
+    for(const auto & [key, info] : mp) {
+        shared::memory::impl::accumulate(stats, info, seen);
+    }
+    
+    return stats;
+}
+
+// Bytes used by each group, one entry per shared value,
+// in the order of the first key of each group
+template <typename Map, typename Key = typename Map::key_type>
+inline std::vector<shared::memory::group_stats_t<Key>> memory_stats_by_group(const Map & mp) {
+    [[maybe_unused]] auto lock = shared::impl::read_lock_map(mp);
+    
+    std::vector<shared::memory::group_stats_t<Key>> stats;
+    std::unordered_map<const void *, std::size_t> indexes;
+    std::unordered_set<const void *> seen;
+    
+    for(const auto & [key, info] : mp) {
+        // Vars without a value are groups of their own
+        const void * group = info.ptr != nullptr ? info.ptr.get() : &info;
+        auto [it, is_new] = indexes.try_emplace(group, stats.size());
+        
+        if(is_new) {
+            stats.push_back({info.group_id, {}});
+        }
+        
+        shared::memory::impl::accumulate(stats[it->second].stats, info, seen);
+    }
+    
+    return stats;
+}
+
+// Bytes used by the vars of each type, indexed by std::type_info::name()
+template <typename Map, typename Key = typename Map::key_type>
+inline std::map<std::string, shared::memory::stats_t> memory_stats_by_type(const Map & mp) {
+    [[maybe_unused]] auto lock = shared::impl::read_lock_map(mp);
+    
+    std::map<std::string, shared::memory::stats_t> stats;
+    std::unordered_set<const void *> seen;
+    
+    for(const auto & [key, info] : mp) {
+        shared::memory::impl::accumulate(stats[info.type_id->name()], info, seen);
+    }
+    
+    return stats;
+}
+
+// Calls a callback when the map uses more than "limit" bytes.
+// The map is measured by check(), call it periodically
+// (for example from a shared::timer::timer_wheel_t), it costs O(n).
+template <typename Map>
+class budget_t {
+public:
+    using callback_type = void (*)(void * context, const shared::memory::stats_t & stats, std::size_t limit);
+    
+    budget_t(const Map & mp, const std::size_t limit, const callback_type callback, void * context = nullptr) :
+        map_(&mp),
+        limit_(limit),
+        callback_(callback),
+        context_(context)
+    {}
+    
+    // Measures the map, calls the callback if it is over the budget.
+    // Returns false if over the budget.
+    bool check() {
+        last_ = shared::memory::memory_stats(*map_);
+        
+        if(last_.total() > limit_) {
+            callback_(context_, last_, limit_);
+            return false;
+        }
+        
+        return true;
+    }
+    
+    std::size_t limit() const {
+        return limit_;
+    }
+    
+    void set_limit(const std::size_t limit) {
+        limit_ = limit;
+    }
+    
+    // The stats measured by the last check()
+    const shared::memory::stats_t & last() const {
+        return last_;
+    }
+    
+private:
+    const Map * map_;
+    std::size_t limit_;
+    callback_type callback_;
+    void * context_;
+    shared::memory::stats_t last_;
+};
+
+} // namespace shared::memory
+
+
+#endif // SHARED_VAR_LIB__MEMORY_STATS_HPP
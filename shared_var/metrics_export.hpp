@@ -0,0 +1,383 @@
+#ifndef SHARED_VAR_LIB__METRICS_EXPORT_HPP
+#define SHARED_VAR_LIB__METRICS_EXPORT_HPP
+
+/* Shared Variable Library
+ * Metrics export
+ * Author:  Yago T. de Mello
+ * e-mail:  yago.t.mello@gmail.com
+ * Version: 2.11.0 2022-07-09
+ * License: Apache 2.0
+ * C++20
+ */
+
+/*
+Copyright 2022 Yago Teodoro de Mello
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+    http://www.apache.org/licenses/LICENSE-2.0
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+// std::max
+#include <algorithm>
+
+// std::rename replaces the metrics file at once
+#include <cstdio>
+
+// the metrics file is written by a std::ofstream
+#include <fstream>
+
+// the groups are counted by their shared value
+#include <unordered_map>
+
+// the lib
+#include "shared_var.hpp"
+
+// exports are scheduled on a timer wheel
+#include "timer_wheel.hpp"
+
+
+// module namespace
+namespace shared::metrics {
+
+// Gauges of a map, computed when exported
+struct map_stats_t {
+    std::size_t vars = 0;
+    std::size_t groups = 0;
+    std::size_t largest_group = 0;
+    
+    // Views with direct access to the var data (shared::info_t::pointers_to_var)
+    std::size_t subscribers = 0;
+    
+    // Per-var observers plus the map-wide observers
+    std::size_t observers = 0;
+};
+
+// Walks the map once, under the read lock of thread safe maps
+template <typename Map, typename Key = typename Map::key_type>
+inline shared::metrics::map_stats_t map_stats(const Map & mp) {
+    [[maybe_unused]] auto lock = shared::impl::read_lock_map(mp);
+    
+    shared::metrics::map_stats_t stats;
+    
+    // Groups may share the id, not the value
+    std::unordered_map<const void *, std::size_t> group_sizes;
+    group_sizes.reserve(mp.size());
+    
+    for(const auto & [key, info] : mp) {
+        stats.vars++;
+        stats.subscribers += info.pointers_to_var.size();
+        stats.observers += info.observers.size();
+        
+        const std::size_t size = ++group_sizes[info.ptr.get()];
+        stats.largest_group = std::max(stats.largest_group, size);
+    }
+    
+    stats.groups = group_sizes.size();
+    
+    if constexpr(requires { mp.observers(); }) {
+        stats.observers += mp.observers().size();
+    }
+    
+    return stats;
+}
+
+} // namespace shared::metrics
+
+
+// Internal use
+namespace shared::metrics::impl {
+
+inline void append_number(std::string & out, const std::uint64_t value) {
+    char buffer[24];
+    const auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+    out.append(buffer, result.ptr);
+}
+
+// Nanoseconds as seconds, the Prometheus base unit
+inline void append_seconds(std::string & out, const std::uint64_t nanoseconds) {
+    char buffer[32];
+    const auto result = std::to_chars(buffer, buffer + sizeof(buffer), double(nanoseconds) * 1e-9);
+    out.append(buffer, result.ptr);
+}
+
+// Label values escape backslashes, double quotes and line feeds
+inline void append_label_value(std::string & out, const std::string_view value) {
+    for(const char c : value) {
+        switch(c) {
+            case '\\': out += "\\\\"; break;
+            case '"':  out += "\\\""; break;
+            case '\n': out += "\\n";  break;
+            default:   out += c;      break;
+        }
+    }
+}
+
+inline void append_header(std::string & out, const std::string_view name, const std::string_view type, const std::string_view help) {
+    out += "# HELP ";
+    out += name;
+    out += ' ';
+    out += help;
+    out += "\n# TYPE ";
+    out += name;
+    out += ' ';
+    out += type;
+    out += '\n';
+}
+
+// One header, then one sample per map
+template <typename Map>
+inline void append_gauge(
+    std::string & out,
+    const std::string_view name,
+    const std::string_view help,
+    const std::vector<std::pair<const Map *, std::string_view>> & maps,
+    const std::vector<shared::metrics::map_stats_t> & stats,
+    std::size_t shared::metrics::map_stats_t::* const field
+) {
+    shared::metrics::impl::append_header(out, name, "gauge", help);
+    
+    for(std::size_t i = 0; i < maps.size(); i++) {
+        out += name;
+        out += "{map=\"";
+        shared::metrics::impl::append_label_value(out, maps[i].second);
+        out += "\"} ";
+        shared::metrics::impl::append_number(out, stats[i].*field);
+        out += '\n';
+    }
+}
+
+#ifdef SHARED_VAR_INSTRUMENTATION
+inline void append_counter(
+    std::string & out,
+    const std::string_view name,
+    const std::string_view help,
+    const std::uint64_t value
+) {
+    shared::metrics::impl::append_header(out, name, "counter", help);
+    out += name;
+    out += ' ';
+    shared::metrics::impl::append_number(out, value);
+    out += '\n';
+}
+
+// A summary with the 50th, 90th and 99th percentiles, in seconds
+inline void append_summary(
+    std::string & out,
+    const std::string_view name,
+    const std::string_view help,
+    const shared::instrumentation::histogram_t & histogram
+) {
+    shared::metrics::impl::append_header(out, name, "summary", help);
+    
+    for(const auto & [quantile, percentile] : {std::pair{"0.5", 50.0}, {"0.9", 90.0}, {"0.99", 99.0}}) {
+        out += name;
+        out += "{quantile=\"";
+        out += quantile;
+        out += "\"} ";
+        shared::metrics::impl::append_seconds(out, histogram.percentile(percentile));
+        out += '\n';
+    }
+    
+    out += name;
+    out += "_sum ";
+    shared::metrics::impl::append_seconds(out, histogram.sum());
+    out += '\n';
+    
+    out += name;
+    out += "_count ";
+    shared::metrics::impl::append_number(out, histogram.count());
+    out += '\n';
+}
+#endif
+
+} // namespace shared::metrics::impl
+
+
+// module namespace
+namespace shared::metrics {
+
+// Appends the metrics of the maps to "out" in the Prometheus text exposition format,
+// each map given as (map, map_name). The map gauges have the label map="map_name".
+// With SHARED_VAR_INSTRUMENTATION, also appends the process-wide counters
+// and the lock and snapshot latencies, without labels.
+// Every metric is written once, so a single call makes a whole exposition:
+// appending a second call to the same output repeats them.
+template <typename Map>
+inline void write_prometheus(std::string & out, const std::vector<std::pair<const Map *, std::string_view>> & maps) {
+    std::vector<shared::metrics::map_stats_t> stats;
+    stats.reserve(maps.size());
+    
+    for(const auto & [mp, map_name] : maps) {
+        stats.push_back(shared::metrics::map_stats(*mp));
+    }
+    
+    using stats_type = shared::metrics::map_stats_t;
+    shared::metrics::impl::append_gauge(out, "shared_var_vars", "Vars in the map.", maps, stats, &stats_type::vars);
+    shared::metrics::impl::append_gauge(out, "shared_var_groups", "Groups of bound vars in the map.", maps, stats, &stats_type::groups);
+    shared::metrics::impl::append_gauge(out, "shared_var_largest_group_vars", "Vars in the largest group.", maps, stats, &stats_type::largest_group);
+    shared::metrics::impl::append_gauge(out, "shared_var_subscribers", "Views subscribed to the vars.", maps, stats, &stats_type::subscribers);
+    shared::metrics::impl::append_gauge(out, "shared_var_observers", "Observers of the vars and of the map.", maps, stats, &stats_type::observers);
+    
+#ifdef SHARED_VAR_INSTRUMENTATION
+    namespace instr = shared::instrumentation;
+    const instr::report_t report = instr::report();
+    
+    shared::metrics::impl::append_counter(out, "shared_var_lookups_total", "Lookups by key.", report[instr::LOOKUPS]);
+    shared::metrics::impl::append_counter(out, "shared_var_creates_total", "Vars created.", report[instr::CREATES]);
+    shared::metrics::impl::append_counter(out, "shared_var_binds_total", "Calls to bind.", report[instr::BINDS]);
+    shared::metrics::impl::append_counter(out, "shared_var_allocations_total", "Var values allocated.", report[instr::ALLOCATIONS]);
+    shared::metrics::impl::append_counter(out, "shared_var_lock_acquisitions_total", "Thread safe map locks.", report[instr::LOCK_ACQUISITIONS]);
+    shared::metrics::impl::append_counter(out, "shared_var_lock_contentions_total", "Thread safe map locks that had to wait.", report[instr::LOCK_CONTENTIONS]);
+    shared::metrics::impl::append_summary(out, "shared_var_lock_wait_seconds", "Time waiting for a thread safe map lock.", report[instr::LOCK_WAIT_NS]);
+    shared::metrics::impl::append_summary(out, "shared_var_lock_hold_seconds", "Time holding a thread safe map lock.", report[instr::LOCK_HOLD_NS]);
+    shared::metrics::impl::append_summary(out, "shared_var_snapshot_seconds", "Time taking a snapshot.", report[instr::SNAPSHOT_NS]);
+    shared::metrics::impl::append_summary(out, "shared_var_restore_seconds", "Time restoring a snapshot.", report[instr::RESTORE_NS]);
+#endif
+}
+
+// Same as above, for a single map
+template <typename Map>
+inline void write_prometheus(std::string & out, const Map & mp, const std::string_view map_name) {
+    shared::metrics::write_prometheus(out, std::vector<std::pair<const Map *, std::string_view>>{{&mp, map_name}});
+}
+
+// Same as above, returning a new string
+template <typename Map>
+inline std::string write_prometheus(const Map & mp, const std::string_view map_name) {
+    std::string out;
+    shared::metrics::write_prometheus(out, mp, map_name);
+    return out;
+}
+
+// Writes "text" to "path" + ".tmp", then renames it to "path",
+// so readers never see a partial file
+inline bool write_file(const std::string & path, const std::string_view text) {
+    const std::string tmp_path = path + ".tmp";
+    
+    {
+        std::ofstream file(tmp_path, std::ios::binary | std::ios::trunc);
+        file.write(text.data(), std::streamsize(text.size()));
+        
+        if(!file) {
+            return false;
+        }
+    }
+    
+    return std::rename(tmp_path.c_str(), path.c_str()) == 0;
+}
+
+// Exports the metrics of a map every "period" ticks of a timer wheel,
+// to a callback or to a file (like the node exporter textfile collector reads).
+// The map is only read when exporting, the hot paths pay only for
+// the instrumentation counters, if enabled.
+// Not thread safe: the wheel must be advanced by a single thread.
+template <typename Map>
+class exporter_t {
+public:
+    using tick_type = shared::timer::timer_wheel_t::tick_type;
+    using callback_type = void (*)(void * context, std::string_view text);
+    
+    // Calls "callback(context, text)" every "period" ticks
+    exporter_t(
+        const Map & mp,
+        shared::timer::timer_wheel_t & wheel,
+        const tick_type period,
+        const callback_type callback,
+        void * context = nullptr,
+        std::string map_name = "default"
+    ) :
+        map_(&mp),
+        wheel_(&wheel),
+        period_(period),
+        callback_(callback),
+        context_(context),
+        map_name_(std::move(map_name))
+    {
+        timer_ = wheel_->schedule(period_, &exporter_t::on_timer, this);
+    }
+    
+    // Replaces the file at "path" every "period" ticks
+    exporter_t(
+        const Map & mp,
+        shared::timer::timer_wheel_t & wheel,
+        const tick_type period,
+        std::string path,
+        std::string map_name = "default"
+    ) :
+        exporter_t(mp, wheel, period, &exporter_t::on_file, this, std::move(map_name))
+    {
+        path_ = std::move(path);
+    }
+    
+    // The address is the timer context, so it cannot move
+    exporter_t(const exporter_t &) = delete;
+    exporter_t & operator =(const exporter_t &) = delete;
+    
+    ~exporter_t() {
+        wheel_->cancel(timer_);
+    }
+    
+    // Exports now, the period is unchanged
+    void export_now() {
+        // The buffer keeps its capacity between exports
+        buffer_.clear();
+        shared::metrics::write_prometheus(buffer_, *map_, map_name_);
+        
+        exports_++;
+        callback_(context_, buffer_);
+    }
+    
+// ==== info ====
+    
+    // How many times the metrics were exported
+    std::size_t exports() const {
+        return exports_;
+    }
+    
+    // How many file writes failed
+    std::size_t failures() const {
+        return failures_;
+    }
+    
+private:
+    const Map * map_;
+    shared::timer::timer_wheel_t * wheel_;
+    tick_type period_;
+    callback_type callback_;
+    void * context_;
+    std::string map_name_;
+    std::string path_;
+    
+    shared::timer::timer_wheel_t::handle_t timer_;
+    std::string buffer_;
+    
+    std::size_t exports_ = 0;
+    std::size_t failures_ = 0;
+    
+    // Called by the wheel
+    static void on_timer(void * context) {
+        exporter_t & self = *reinterpret_cast<exporter_t *>(context);
+        self.timer_ = self.wheel_->schedule(self.period_, &exporter_t::on_timer, context);
+        self.export_now();
+    }
+    
+    // The callback of the file exporters
+    static void on_file(void * context, const std::string_view text) {
+        exporter_t & self = *reinterpret_cast<exporter_t *>(context);
+        
+        if(!shared::metrics::write_file(self.path_, text)) {
+            self.failures_++;
+        }
+    }
+};
+
+} // namespace shared::metrics
+
+
+#endif // SHARED_VAR_LIB__METRICS_EXPORT_HPP
@@ -29,4 +29,6 @@ limitations under the License.
 
 #include "thread_safe_views.hpp"
 
+#include "extern_templates.hpp"
+
 #endif // SHARED_VAR_LIB__MULTITHREAD_HPP
@@ -0,0 +1,252 @@
+#ifndef SHARED_VAR_LIB__PARALLEL_SNAPSHOT_HPP
+#define SHARED_VAR_LIB__PARALLEL_SNAPSHOT_HPP
+
+/* Shared Variable Library
+ * Parallel snapshot
+ * Author:  Yago T. de Mello
+ * e-mail:  yago.t.mello@gmail.com
+ * Version: 2.11.0 2022-07-09
+ * License: Apache 2.0
+ * C++20
+ */
+
+/*
+Copyright 2022 Yago Teodoro de Mello
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+    http://www.apache.org/licenses/LICENSE-2.0
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+// the worker threads
+#include <thread>
+
+// errors thrown by the copiers are rethrown by the caller
+#include <exception>
+
+// the lib
+#include "shared_var.hpp"
+
+
+// module namespace
+namespace shared::parallel {
+
+// Below this many vars per thread, starting a thread costs more than it saves
+inline constexpr std::size_t min_vars_per_thread = 4096;
+
+// One thread per core
+inline unsigned int default_threads() {
+    return std::max(1u, std::thread::hardware_concurrency());
+}
+
+} // namespace shared::parallel
+
+
+// Internal use
+namespace shared::parallel::impl {
+
+// The threads worth using for "count" vars, at most "threads"
+inline unsigned int thread_count(const std::size_t count, const unsigned int threads) {
+    const std::size_t useful = std::max<std::size_t>(1, count / shared::parallel::min_vars_per_thread);
+    return static_cast<unsigned int>(std::min<std::size_t>(useful, std::max(1u, threads)));
+}
+
+// The range [begin, end) of the partition, the first ones get the remainder
+inline std::pair<std::size_t, std::size_t> slice(
+    const std::size_t count,
+    const unsigned int partition,
+    const unsigned int partitions
+) {
+    const std::size_t size = count / partitions;
+    const std::size_t remainder = count % partitions;
+    const std::size_t begin = partition * size + std::min<std::size_t>(partition, remainder);
+    
+    return {begin, begin + size + (partition < remainder ? 1 : 0)};
+}
+
+// Spreads the addresses, they are aligned and would pile up in few partitions
+inline unsigned int partition_of(const void * address, const unsigned int partitions) {
+    const auto hash = static_cast<std::uint64_t>(reinterpret_cast<std::uintptr_t>(address)) * 0x9E3779B97F4A7C15ull;
+    return static_cast<unsigned int>((hash >> 32) % partitions);
+}
+
+// Calls function(partition) for every partition, the partition 0 runs in this thread.
+// The first exception thrown is rethrown after every thread has finished.
+template <typename Function>
+inline void for_each_partition(const unsigned int partitions, Function && function) {
+    std::vector<std::exception_ptr> errors(partitions);
+    
+    auto run = [&](const unsigned int partition) {
+        try {
+            function(partition);
+        }
+        catch(...) {
+            errors[partition] = std::current_exception();
+        }
+    };
+    
+    {
+        // Joined at the end of the scope, even if a thread fails to start
+        std::vector<std::jthread> workers;
+        workers.reserve(partitions - 1);
+        
+        for(unsigned int partition = 1; partition < partitions; partition++) {
+            workers.emplace_back(run, partition);
+        }
+        
+        run(0);
+    }
+    
+    for(const std::exception_ptr & error : errors) {
+        if(error) std::rethrow_exception(error);
+    }
+}
+
+// What shared::restore does with a saved var
+enum restore_action_t : uint_fast8_t {
+    COPY_VALUE,  // same type, the value is copied to the existing memory
+    REPLACE_VAR, // different type, the var is overwritten
+    CREATE_VAR   // removed var, re-created alone in its group
+};
+
+// A saved var and its destination in the map
+template <typename Key>
+struct restore_task_t {
+    shared::info_t<Key> * src;
+    shared::info_t<Key> * dest;
+    restore_action_t action;
+};
+
+} // namespace shared::parallel::impl
+
+
+// module namespace
+namespace shared::parallel {
+
+// Same as shared::snapshot, the vars are cloned by "threads" threads.
+// The map is split in key ranges, so the order is the same.
+// Small maps use fewer threads, see shared::parallel::min_vars_per_thread.
+template <typename Map, typename Key = typename Map::key_type>
+inline std::vector<shared::info_t<Key>> snapshot(
+    const Map & mp,
+    const unsigned int threads = shared::parallel::default_threads()
+) {
+    const unsigned int partitions = shared::parallel::impl::thread_count(mp.size(), threads);
+    
+    if(partitions == 1) {
+        return shared::snapshot(mp);
+    }
+    
+    SHARED_VAR_TIME_SCOPE(SNAPSHOT_NS);
+    
+    // The map has no random access, so the vars are listed first
+    std::vector<const shared::info_t<Key> *> sources;
+    sources.reserve(mp.size());
+    
+    for(const auto & [key, info] : mp) {
+        sources.push_back(&info);
+    }
+    
+    std::vector<shared::info_t<Key>> data(sources.size());
+    
+    shared::parallel::impl::for_each_partition(partitions, [&](const unsigned int partition) {
+        const auto [begin, end] = shared::parallel::impl::slice(sources.size(), partition, partitions);
+        
+        for(std::size_t index = begin; index < end; index++) {
+            data[index] = shared::impl::clone_info(*sources[index]);
+        }
+    });
+    
+    return data;
+}
+
+// Same as shared::restore, the values are copied by "threads" threads.
+// The lookups are done first by the calling thread. Then each var is restored
+// by the thread owning its memory: vars still sharing memory are copied by the
+// same thread, in the same order as shared::restore. The re-created vars change
+// the map, so they are inserted last by the calling thread, and only if every
+// copy succeeded.
+template <typename Map, typename Key = typename Map::key_type>
+inline void restore(
+    Map & mp,
+    std::vector<shared::info_t<Key>> data,
+    const unsigned int threads = shared::parallel::default_threads()
+) {
+    using task_type = shared::parallel::impl::restore_task_t<Key>;
+    
+    const unsigned int partitions = shared::parallel::impl::thread_count(data.size(), threads);
+    
+    if(partitions == 1) {
+        shared::restore(mp, std::move(data));
+        return;
+    }
+    
+    SHARED_VAR_TIME_SCOPE(RESTORE_NS);
+    
+    std::vector<std::vector<task_type>> tasks(partitions);
+    std::vector<shared::info_t<Key> *> created;
+    
+    for(std::vector<task_type> & partition_tasks : tasks) {
+        partition_tasks.reserve(data.size() / partitions + data.size() / (4 * partitions));
+    }
+    
+    for(shared::info_t<Key> & info_src : data) {
+        auto it_dest = mp.find(info_src.key);
+        
+        if(it_dest != mp.end()) {
+            shared::info_t<Key> & info_dest = shared::impl::iter_to_info<Map>(it_dest);
+            
+            if(info_src.type_id == info_dest.type_id) {
+                // Owned by the thread of the memory, shared by the group
+                const unsigned int partition = shared::parallel::impl::partition_of(info_dest.ptr.get(), partitions);
+                tasks[partition].push_back({&info_src, &info_dest, shared::parallel::impl::COPY_VALUE});
+            }
+            else {
+                const unsigned int partition = shared::parallel::impl::partition_of(&info_dest, partitions);
+                tasks[partition].push_back({&info_src, &info_dest, shared::parallel::impl::REPLACE_VAR});
+            }
+        }
+        else {
+            // Cloned in place, inserted only after every copy succeeded
+            const unsigned int partition = shared::parallel::impl::partition_of(&info_src, partitions);
+            tasks[partition].push_back({&info_src, &info_src, shared::parallel::impl::CREATE_VAR});
+            created.push_back(&info_src);
+        }
+    }
+    
+    shared::parallel::impl::for_each_partition(partitions, [&](const unsigned int partition) {
+        for(const task_type & task : tasks[partition]) {
+            switch(task.action) {
+                case shared::parallel::impl::COPY_VALUE:
+                    task.src->copier(task.dest->ptr.get(), task.src->ptr.get());
+                    break;
+                    
+                case shared::parallel::impl::REPLACE_VAR:
+                    shared::impl::disconnect_subscribers(*task.dest);
+                    *task.dest = shared::impl::clone_info(*task.src);
+                    break;
+                    
+                case shared::parallel::impl::CREATE_VAR:
+                    *task.dest = shared::impl::clone_info(*task.src);
+                    break;
+            }
+        }
+    });
+    
+    // Re-created alone in their groups because the refs are not restored
+    for(shared::info_t<Key> * info_src : created) {
+        shared::info_t<Key> & info_new = mp[info_src->key];
+        info_new = std::move(*info_src);
+        info_new.group_id = info_new.key;
+    }
+}
+
+} // namespace shared::parallel
+
+
+#endif // SHARED_VAR_LIB__PARALLEL_SNAPSHOT_HPP
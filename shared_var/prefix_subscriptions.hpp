@@ -0,0 +1,264 @@
+#ifndef SHARED_VAR_LIB__PREFIX_SUBSCRIPTIONS_HPP
+#define SHARED_VAR_LIB__PREFIX_SUBSCRIPTIONS_HPP
+
+/* Shared Variable Library
+ * Prefix subscriptions
+ * Author:  Yago T. de Mello
+ * e-mail:  yago.t.mello@gmail.com
+ * Version: 2.11.0 2022-07-09
+ * License: Apache 2.0
+ * C++20
+ */
+
+/*
+Copyright 2022 Yago Teodoro de Mello
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+    http://www.apache.org/licenses/LICENSE-2.0
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+// std::lower_bound
+#include <algorithm>
+
+// the trie nodes are stored in a std::deque, references stay valid
+#include <deque>
+
+// the lib
+#include "shared_var.hpp"
+
+
+// module namespace
+namespace shared::prefix {
+
+// Keys made of a sequence of symbols, like std::string
+template <typename Key>
+concept sequence = requires (const Key & key) {
+    typename Key::value_type;
+    key.begin();
+    key.end();
+};
+
+// Observers of every var with a key starting with a given prefix,
+// including vars created later.
+// The prefixes are stored in a trie: a change walks the trie along the key,
+// costing O(key length) no matter how many prefixes are subscribed.
+// The subscriptions fire on shared::notify and shared::remove, after the per-var observers.
+// On thread safe maps the callbacks are called with the map locked,
+// so they must not subscribe nor unsubscribe.
+template <typename Map, typename Key = typename Map::key_type>
+requires shared::prefix::sequence<Key>
+class prefix_subscriptions_t {
+public:
+    using key_type = Key;
+    using symbol_type = typename Key::value_type;
+    using callback_type = typename shared::observer_t<Key>::callback_type;
+    
+    explicit prefix_subscriptions_t(Map & mp) : map_(&mp) {
+        // The root holds the subscriptions to the empty prefix
+        nodes_.emplace_back();
+        
+        [[maybe_unused]] auto lock = shared::impl::lock_map(mp);
+        shared::observe_map(mp, &prefix_subscriptions_t::on_event, this);
+    }
+    
+    // The address is the observer context, so it cannot move
+    prefix_subscriptions_t(const prefix_subscriptions_t &) = delete;
+    prefix_subscriptions_t & operator =(const prefix_subscriptions_t &) = delete;
+    
+    ~prefix_subscriptions_t() {
+        [[maybe_unused]] auto lock = shared::impl::lock_map(*map_);
+        shared::unobserve_map(*map_, &prefix_subscriptions_t::on_event, this);
+    }
+    
+    // Calls "callback" for every change of a var starting with "prefix".
+    // Returning false from the callback unsubscribes it.
+    void subscribe(const Key & prefix, const callback_type callback, void * context = nullptr) {
+        [[maybe_unused]] auto lock = shared::impl::lock_map(*map_);
+        
+        std::size_t index = 0;
+        
+        for(const symbol_type & symbol : prefix) {
+            index = this->child(index, symbol, true);
+        }
+        
+        nodes_[index].observers.push_back({callback, context});
+    }
+    
+    // Nodes left without subscriptions are removed from the trie
+    void unsubscribe(const Key & prefix, const callback_type callback, void * context = nullptr) {
+        [[maybe_unused]] auto lock = shared::impl::lock_map(*map_);
+        
+        // The nodes from the root to the prefix
+        std::vector<std::size_t> path = {0};
+        
+        for(const symbol_type & symbol : prefix) {
+            const std::size_t index = this->child(path.back(), symbol, false);
+            if(index == no_node) return;
+            path.push_back(index);
+        }
+        
+        shared::impl::erase_observer(nodes_[path.back()].observers, callback, context);
+        
+        if(firing_ > 0) {
+            // The nodes being fired are pruned after the callbacks return
+            is_prune_pending_ = true;
+            return;
+        }
+        
+        // Removing the empty leaves on the way back up
+        for(std::size_t depth = path.size() - 1; depth > 0 && this->is_empty(path[depth]); depth--) {
+            this->erase_child(path[depth - 1], path[depth]);
+        }
+    }
+    
+    // How many subscriptions exist
+    std::size_t size() const {
+        std::size_t count = 0;
+        
+        for(const node_t & node : nodes_) {
+            count += node.observers.size();
+        }
+        
+        return count;
+    }
+    
+    // How many trie nodes are in use, including the root
+    std::size_t node_count() const {
+        return nodes_.size() - free_nodes_.size();
+    }
+    
+private:
+    static constexpr std::size_t no_node = ~std::size_t(0);
+    
+    struct node_t {
+        // Sorted by symbol, most nodes have few children
+        std::vector<std::pair<symbol_type, std::size_t>> children;
+        std::vector<shared::observer_t<Key>> observers;
+    };
+    
+    Map * map_;
+    std::deque<node_t> nodes_;
+    
+    // Pruned nodes, reused by the next subscriptions
+    std::vector<std::size_t> free_nodes_;
+    
+    // Nodes are not pruned while their observers are being called
+    std::size_t firing_ = 0;
+    bool is_prune_pending_ = false;
+    
+    // Finds the child of "index" following "symbol",
+    // creating the node if "should_create" is true
+    std::size_t child(const std::size_t index, const symbol_type & symbol, const bool should_create) {
+        auto & children = nodes_[index].children;
+        
+        auto it = std::lower_bound(children.begin(), children.end(), symbol, [](const auto & child, const symbol_type & value) {
+            return child.first < value;
+        });
+        
+        if(it != children.end() && it->first == symbol) {
+            return it->second;
+        }
+        else if(should_create) {
+            std::size_t new_index;
+            
+            if(free_nodes_.empty()) {
+                new_index = nodes_.size();
+                nodes_.emplace_back();
+            }
+            else {
+                new_index = free_nodes_.back();
+                free_nodes_.pop_back();
+            }
+            
+            children.insert(it, {symbol, new_index});
+            return new_index;
+        }
+        else {
+            return no_node;
+        }
+    }
+    
+    // A node without subscriptions nor children
+    bool is_empty(const std::size_t index) const {
+        return nodes_[index].observers.empty() && nodes_[index].children.empty();
+    }
+    
+    // Unlinks the node from its parent, and frees it
+    void erase_child(const std::size_t parent, const std::size_t index) {
+        auto & children = nodes_[parent].children;
+        
+        std::erase_if(children, [index](const auto & child) {
+            return child.second == index;
+        });
+        
+        nodes_[index] = node_t();
+        free_nodes_.push_back(index);
+    }
+    
+    // Removes the empty nodes under "index",
+    // returns true if "index" itself is empty
+    bool prune(const std::size_t index) {
+        auto & children = nodes_[index].children;
+        
+        for(std::size_t i = 0; i < children.size();) {
+            if(this->prune(children[i].second)) {
+                this->erase_child(index, children[i].second);
+            }
+            else {
+                i++;
+            }
+        }
+        
+        return this->is_empty(index);
+    }
+    
+    // Fires the subscriptions of every prefix of the key
+    void fire(const shared::info_t<Key> & info, const shared::event_t event) {
+        std::size_t index = 0;
+        auto it = info.key.begin();
+        
+        firing_++;
+        
+        while(true) {
+            // Callbacks may add nodes, the deque keeps the references valid
+            auto & observers = nodes_[index].observers;
+            const std::size_t count = observers.size();
+            
+            shared::impl::fire_observers(observers, info, event);
+            
+            // Callbacks returning false unsubscribe
+            if(observers.size() < count) is_prune_pending_ = true;
+            
+            if(it == info.key.end()) break;
+            
+            index = this->child(index, *it, false);
+            if(index == no_node) break;
+            
+            ++it;
+        }
+        
+        firing_--;
+        
+        if(firing_ == 0 && is_prune_pending_) {
+            is_prune_pending_ = false;
+            this->prune(0);
+        }
+    }
+    
+    // Called by shared::notify and shared::remove
+    static bool on_event(void * context, const shared::info_t<Key> & info, const shared::event_t event) {
+        reinterpret_cast<prefix_subscriptions_t *>(context)->fire(info, event);
+        return true;
+    }
+};
+
+} // namespace shared::prefix
+
+
+#endif // SHARED_VAR_LIB__PREFIX_SUBSCRIPTIONS_HPP
@@ -0,0 +1,185 @@
+#ifndef SHARED_VAR_LIB__RATE_LIMIT_HPP
+#define SHARED_VAR_LIB__RATE_LIMIT_HPP
+
+/* Shared Variable Library
+ * Rate limit
+ * Author:  Yago T. de Mello
+ * e-mail:  yago.t.mello@gmail.com
+ * Version: 2.11.0 2022-07-09
+ * License: Apache 2.0
+ * C++20
+ */
+
+/*
+Copyright 2022 Yago Teodoro de Mello
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+    http://www.apache.org/licenses/LICENSE-2.0
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+// the lib
+#include "shared_var.hpp"
+
+// deliveries are scheduled on a timer wheel
+#include "timer_wheel.hpp"
+
+
+// module namespace
+namespace shared::rate_limit {
+
+// How the changes are coalesced
+enum policy_t : uint_fast8_t {
+    // Delivers once the var stays unchanged for "period" ticks
+    DEBOUNCE = 0,
+    // Delivers at most once every "period" ticks
+    THROTTLE = 1
+};
+
+// Observes a var and delivers its latest value at a bounded rate.
+// Every shared::notify is coalesced until the wheel fires the delivery,
+// the callback receives the value at the delivery time.
+// Not thread safe: the wheel must be advanced by the thread notifying the var.
+template <shared::storable T, typename Map, typename Key = typename Map::key_type>
+class limited_observer_t {
+public:
+    using key_type = Key;
+    using value_type = T;
+    using tick_type = shared::timer::timer_wheel_t::tick_type;
+    using callback_type = void (*)(void * context, const T & value);
+    
+    limited_observer_t(
+        Map & mp,
+        const std::type_identity_t<Key> & key,
+        shared::timer::timer_wheel_t & wheel,
+        const shared::rate_limit::policy_t policy,
+        const tick_type period,
+        const callback_type callback,
+        void * context = nullptr
+    ) :
+        map_(&mp),
+        key_(key),
+        wheel_(&wheel),
+        policy_(policy),
+        period_(period),
+        callback_(callback),
+        context_(context)
+    {
+        is_observing_ = shared::observe(mp, key, &limited_observer_t::on_event, this);
+    }
+    
+    // The observer address is the observer and timer context, so it cannot move
+    limited_observer_t(const limited_observer_t &) = delete;
+    limited_observer_t & operator =(const limited_observer_t &) = delete;
+    
+    ~limited_observer_t() {
+        wheel_->cancel(timer_);
+        
+        if(is_observing_) {
+            shared::unobserve(*map_, key_, &limited_observer_t::on_event, this);
+        }
+    }
+    
+    // Delivers the pending change now
+    void flush() {
+        if(wheel_->cancel(timer_)) {
+            this->deliver();
+        }
+    }
+    
+// ==== info ====
+    
+    // True if a change is waiting to be delivered
+    bool is_pending() const {
+        return wheel_->is_scheduled(timer_);
+    }
+    
+    // False after the var is removed
+    bool is_observing() const {
+        return is_observing_;
+    }
+    
+    // How many changes were notified
+    std::size_t changes() const {
+        return changes_;
+    }
+    
+    // How many times the callback was called
+    std::size_t deliveries() const {
+        return deliveries_;
+    }
+    
+private:
+    Map * map_;
+    Key key_;
+    shared::timer::timer_wheel_t * wheel_;
+    shared::rate_limit::policy_t policy_;
+    tick_type period_;
+    callback_type callback_;
+    void * context_;
+    
+    shared::timer::timer_wheel_t::handle_t timer_;
+    tick_type last_delivery_ = 0;
+    bool has_delivered_ = false;
+    bool is_observing_ = false;
+    
+    std::size_t changes_ = 0;
+    std::size_t deliveries_ = 0;
+    
+    void deliver() {
+        const T * ptr = shared::get_ptr<T>(*map_, key_);
+        
+        if(ptr != nullptr) {
+            last_delivery_ = wheel_->now();
+            has_delivered_ = true;
+            deliveries_++;
+            callback_(context_, *ptr);
+        }
+    }
+    
+    // Called by shared::notify and shared::remove
+    static bool on_event(void * context, const shared::info_t<Key> &, const shared::event_t event) {
+        limited_observer_t & self = *reinterpret_cast<limited_observer_t *>(context);
+        
+        if(event == shared::VAR_REMOVED) {
+            self.wheel_->cancel(self.timer_);
+            self.is_observing_ = false;
+            return false;
+        }
+        
+        self.changes_++;
+        
+        if(self.policy_ == shared::rate_limit::DEBOUNCE) {
+            // Every change restarts the quiet period
+            self.wheel_->cancel(self.timer_);
+            self.timer_ = self.wheel_->schedule(self.period_, &limited_observer_t::on_timer, context);
+        }
+        else if(!self.is_pending()) {
+            // The first change after a delivery waits for the rest of the period,
+            // the next ones are coalesced into the same delivery
+            const tick_type now = self.wheel_->now();
+            const tick_type ready_at = self.has_delivered_ ? self.last_delivery_ + self.period_ : now;
+            const tick_type delay = ready_at > now ? ready_at - now : 0;
+            
+            self.timer_ = self.wheel_->schedule(delay, &limited_observer_t::on_timer, context);
+        }
+        
+        return true;
+    }
+    
+    // Called by the wheel
+    static void on_timer(void * context) {
+        limited_observer_t & self = *reinterpret_cast<limited_observer_t *>(context);
+        self.deliver();
+    }
+};
+
+} // namespace shared::rate_limit
+
+
+#endif // SHARED_VAR_LIB__RATE_LIMIT_HPP
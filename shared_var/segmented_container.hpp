@@ -0,0 +1,207 @@
+#ifndef SHARED_VAR_LIB__SEGMENTED_CONTAINER_HPP
+#define SHARED_VAR_LIB__SEGMENTED_CONTAINER_HPP
+
+/* Shared Variable Library
+ * Segmented container
+ * Author:  Yago T. de Mello
+ * e-mail:  yago.t.mello@gmail.com
+ * Version: 2.11.0 2022-07-09
+ * License: Apache 2.0
+ * C++20
+ */
+
+/*
+Copyright 2022 Yago Teodoro de Mello
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+    http://www.apache.org/licenses/LICENSE-2.0
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+// the chunks are allocated with the aligned operator new
+#include <new>
+
+// the lib
+#include "shared_var.hpp"
+
+// the objects are built from the map builders
+#include "shared_builder.hpp"
+
+
+// module namespace
+namespace shared::builder {
+
+// Polymorphic container of objects built from the map builders.
+// Each Derived type has its own segment, a list of contiguous chunks,
+// so iterating visits the objects type by type and in memory order:
+// the virtual calls of a segment always go to the same function.
+// Objects never move, pointers stay valid until clear().
+template <typename Base>
+class segmented_t {
+public:
+    // Capacity of the first chunk of a segment, the next ones double
+    static constexpr std::size_t first_chunk_capacity = 16;
+    
+    segmented_t() = default;
+    
+    // The objects may not be copyable
+    segmented_t(const segmented_t &) = delete;
+    segmented_t & operator =(const segmented_t &) = delete;
+    
+    segmented_t(segmented_t && other) noexcept :
+        segments_(std::move(other.segments_)),
+        size_(std::exchange(other.size_, 0))
+    {}
+    
+    segmented_t & operator =(segmented_t && other) noexcept {
+        if(this != &other) {
+            this->clear();
+            segments_ = std::move(other.segments_);
+            size_ = std::exchange(other.size_, 0);
+        }
+        
+        return *this;
+    }
+    
+    ~segmented_t() {
+        this->clear();
+    }
+    
+    // Builds an object with the builder "key" at the end of its type segment.
+    // Returns nullptr if the builder doesn't exist, or was made from a Base * (*)().
+    template <typename Map, typename Key = typename Map::key_type>
+    Base * emplace(Map & mp, const std::type_identity_t<Key> & key) {
+        shared::builder_type<Base> builder = shared::get<shared::builder_type<Base>>(mp, key);
+        
+        // Builders from plain function pointers don't know the Derived size
+        if(builder.ops == nullptr) return nullptr;
+        
+        return this->emplace_ops(*builder.ops);
+    }
+    
+    // Builds an object of Derived type, without a builder
+    template <typename Derived>
+    Base * emplace() {
+        return this->emplace_ops(shared::builder::type_ops<Base, Derived>);
+    }
+    
+    // Calls "fn(Base &)" for every object, segment by segment
+    template <typename Fn>
+    void for_each(Fn && fn) const {
+        for(const segment_t & segment : segments_) {
+            const std::size_t stride = segment.ops->size;
+            
+            for(const chunk_t & chunk : segment.chunks) {
+                std::byte * ptr = chunk.data + segment.base_offset;
+                std::byte * const end = ptr + chunk.size * stride;
+                
+                for(; ptr != end; ptr += stride) {
+                    fn(*reinterpret_cast<Base *>(ptr));
+                }
+            }
+        }
+    }
+    
+    // Destroys every object and frees the memory
+    void clear() {
+        for(segment_t & segment : segments_) {
+            for(chunk_t & chunk : segment.chunks) {
+                for(std::size_t i = 0; i < chunk.size; i++) {
+                    segment.ops->destroy(chunk.data + i * segment.ops->size);
+                }
+                
+                ::operator delete(chunk.data, std::align_val_t(segment.ops->alignment));
+            }
+        }
+        
+        segments_.clear();
+        size_ = 0;
+    }
+    
+    // How many objects exist
+    std::size_t size() const {
+        return size_;
+    }
+    
+    bool empty() const {
+        return size_ == 0;
+    }
+    
+    // How many Derived types exist
+    std::size_t segment_count() const {
+        return segments_.size();
+    }
+    
+private:
+    struct chunk_t {
+        std::byte * data = nullptr;
+        std::size_t size = 0;
+        std::size_t capacity = 0;
+    };
+    
+    struct segment_t {
+        const shared::builder::type_ops_t<Base> * ops = nullptr;
+        std::vector<chunk_t> chunks;
+        
+        // Where the Base is inside the Derived object,
+        // known after the first object is built
+        std::ptrdiff_t base_offset = 0;
+    };
+    
+    // Few types, a linear search is faster than a map
+    std::vector<segment_t> segments_;
+    std::size_t size_ = 0;
+    
+    segment_t & find_segment(const shared::builder::type_ops_t<Base> & ops) {
+        for(segment_t & segment : segments_) {
+            if(segment.ops == &ops) return segment;
+        }
+        
+        segment_t & segment = segments_.emplace_back();
+        segment.ops = &ops;
+        return segment;
+    }
+    
+    Base * emplace_ops(const shared::builder::type_ops_t<Base> & ops) {
+        segment_t & segment = this->find_segment(ops);
+        
+        if(segment.chunks.empty() || segment.chunks.back().size == segment.chunks.back().capacity) {
+            const std::size_t capacity = segment.chunks.empty()
+                ? first_chunk_capacity
+                : segment.chunks.back().capacity * 2;
+                
+            chunk_t chunk;
+            chunk.data = static_cast<std::byte *>(::operator new(capacity * ops.size, std::align_val_t(ops.alignment)));
+            chunk.capacity = capacity;
+            
+            try {
+                segment.chunks.push_back(chunk);
+            }
+            catch(...) {
+                ::operator delete(chunk.data, std::align_val_t(ops.alignment));
+                throw;
+            }
+        }
+        
+        chunk_t & chunk = segment.chunks.back();
+        std::byte * where = chunk.data + chunk.size * ops.size;
+        
+        Base * ptr = ops.construct(where);
+        segment.base_offset = reinterpret_cast<std::byte *>(ptr) - where;
+        
+        chunk.size++;
+        size_++;
+        
+        return ptr;
+    }
+};
+
+} // namespace shared::builder
+
+
+#endif // SHARED_VAR_LIB__SEGMENTED_CONTAINER_HPP
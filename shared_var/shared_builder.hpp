@@ -23,6 +23,12 @@ See the License for the specific language governing permissions and
 limitations under the License.
 */
 
+// builders can allocate from a std::pmr::memory_resource
+#include <memory_resource>
+
+// std::memcpy
+#include <cstring>
+
 #include "shared_var.hpp"
 
 
@@ -35,6 +41,450 @@ inline Base * default_builder() {
     return new Derived;
 }
 
+// Constructs an object of Derived type and its control block
+// in a single allocation
+template <typename Base, typename Derived>
+inline std::shared_ptr<Base> default_shared_builder() {
+    return std::make_shared<Derived>();
+}
+
+// Same as above, allocating from "resource"
+template <typename Base, typename Derived>
+inline std::shared_ptr<Base> default_shared_pmr_builder(std::pmr::memory_resource * resource) {
+    return std::allocate_shared<Derived>(std::pmr::polymorphic_allocator<Derived>(resource));
+}
+
+// Constructs an object of Derived type in memory from "resource"
+template <typename Base, typename Derived>
+inline Base * default_pmr_builder(std::pmr::memory_resource * resource) {
+    std::pmr::polymorphic_allocator<Derived> allocator(resource);
+    
+    Derived * ptr = allocator.allocate(1);
+    
+    try {
+        allocator.construct(ptr);
+    }
+    catch(...) {
+        allocator.deallocate(ptr, 1);
+        throw;
+    }
+    
+    return ptr;
+}
+
+// Destroys an object built by default_pmr_builder<Base, Derived>
+template <typename Base, typename Derived>
+inline void default_pmr_destroyer(Base * ptr, std::pmr::memory_resource * resource) {
+    Derived * derived = static_cast<Derived *>(ptr);
+    std::destroy_at(derived);
+    std::pmr::polymorphic_allocator<Derived>(resource).deallocate(derived, 1);
+}
+
+// Objects of the same Derived type, constructed contiguously
+template <typename Base>
+struct block_t {
+    std::byte * data = nullptr;
+    std::size_t count = 0;
+    
+    // sizeof(Derived)
+    std::size_t stride = 0;
+    
+    // Where the Base is inside the Derived object
+    std::ptrdiff_t base_offset = 0;
+    
+    // Destroys the objects and deallocates the block
+    void (*destroy)(std::byte * data, std::size_t count) = nullptr;
+};
+
+// Destroys a block built by default_block_builder<Base, Derived>
+template <typename Base, typename Derived>
+inline void default_block_destroyer(std::byte * data, const std::size_t count) {
+    Derived * objects = reinterpret_cast<Derived *>(data);
+    std::destroy_n(objects, count);
+    std::allocator<Derived>().deallocate(objects, count);
+}
+
+// Constructs "count" objects of Derived type in a single allocation
+template <typename Base, typename Derived>
+inline shared::builder::block_t<Base> default_block_builder(const std::size_t count) {
+    shared::builder::block_t<Base> block;
+    
+    if(count == 0) return block;
+    
+    Derived * objects = std::allocator<Derived>().allocate(count);
+    std::size_t constructed = 0;
+    
+    try {
+        for(; constructed < count; constructed++) {
+            std::construct_at(objects + constructed);
+        }
+    }
+    catch(...) {
+        std::destroy_n(objects, constructed);
+        std::allocator<Derived>().deallocate(objects, count);
+        throw;
+    }
+    
+    block.data        = reinterpret_cast<std::byte *>(objects);
+    block.count       = count;
+    block.stride      = sizeof(Derived);
+    block.base_offset = reinterpret_cast<std::byte *>(static_cast<Base *>(objects)) - block.data;
+    block.destroy     = &shared::builder::default_block_destroyer<Base, Derived>;
+    return block;
+}
+
+// Objects with a "reset()" member are reset by calling it,
+// the others are destroyed and constructed again in the same memory
+template <typename T>
+concept resettable = requires (T & obj) {
+    obj.reset();
+};
+
+// How many free objects each thread keeps for each Derived type,
+// the extra ones are deleted
+inline constexpr std::size_t pool_capacity = 256;
+
+// Free objects of Derived type, one list per thread
+template <typename Derived>
+class pool_t {
+public:
+    ~pool_t() {
+        // Objects released from now on are deleted
+        is_destroyed_ = true;
+        
+        for(Derived * ptr : free_) {
+            delete ptr;
+        }
+    }
+    
+    static pool_t & local() {
+        thread_local pool_t pool;
+        return pool;
+    }
+    
+    // True after the pool of this thread was destroyed, at thread exit.
+    // Objects released later, like by other thread_local destructors,
+    // can't use it.
+    static bool is_destroyed() {
+        return is_destroyed_;
+    }
+    
+    Derived * take() {
+        if(free_.empty()) {
+            return new Derived;
+        }
+        
+        Derived * ptr = free_.back();
+        free_.pop_back();
+        return ptr;
+    }
+    
+    void give(Derived * ptr) {
+        if(free_.size() >= shared::builder::pool_capacity) {
+            delete ptr;
+            return;
+        }
+        
+        if constexpr(shared::builder::resettable<Derived>) {
+            ptr->reset();
+        }
+        else if constexpr(std::is_nothrow_default_constructible_v<Derived>) {
+            std::destroy_at(ptr);
+            std::construct_at(ptr);
+        }
+        else {
+            // A throwing constructor would leave a destroyed object,
+            // deleted again by the caller
+            delete ptr;
+            return;
+        }
+        
+        free_.push_back(ptr);
+    }
+    
+    std::size_t size() const {
+        return free_.size();
+    }
+    
+private:
+    std::vector<Derived *> free_;
+    
+    // Trivially destructible, still readable after the pool is destroyed
+    static inline thread_local bool is_destroyed_ = false;
+};
+
+// Takes an object of Derived type from the pool of this thread
+template <typename Base, typename Derived>
+inline Base * default_pooled_builder() {
+    if(shared::builder::pool_t<Derived>::is_destroyed()) {
+        return new Derived;
+    }
+    
+    return shared::builder::pool_t<Derived>::local().take();
+}
+
+// Returns an object built by default_pooled_builder<Base, Derived>
+// to the pool of this thread
+template <typename Base, typename Derived>
+inline void default_recycler(Base * ptr) {
+    if(shared::builder::pool_t<Derived>::is_destroyed()) {
+        delete static_cast<Derived *>(ptr);
+        return;
+    }
+    
+    shared::builder::pool_t<Derived>::local().give(static_cast<Derived *>(ptr));
+}
+
+// Constructs and destroys Derived objects in memory owned by someone else,
+// like shared::builder::segmented_t
+template <typename Base>
+struct type_ops_t {
+    std::size_t size = 0;
+    std::size_t alignment = 0;
+    
+    // Constructs a Derived object in "where", returns its Base
+    Base * (*construct)(std::byte * where) = nullptr;
+    
+    // Destroys the Derived object in "where"
+    void (*destroy)(std::byte * where) = nullptr;
+};
+
+// One instance per Derived type, the address identifies the type
+template <typename Base, typename Derived>
+inline constexpr shared::builder::type_ops_t<Base> type_ops = {
+    sizeof(Derived),
+    alignof(Derived),
+    [](std::byte * where) -> Base * {
+        return std::construct_at(reinterpret_cast<Derived *>(where));
+    },
+    [](std::byte * where) {
+        std::destroy_at(reinterpret_cast<Derived *>(where));
+    }
+};
+
+// Deletes the objects of builders without a pool
+template <typename Base>
+inline void default_deleter(Base * ptr) {
+    delete ptr;
+}
+
+// How a Derived object is built, stored in the map by make_builder.
+// Every member knows the Derived type, so objects built from
+// a memory resource can also be destroyed from a Base *.
+template <typename Base>
+struct builder_t {
+    Base * (*build)() = nullptr;
+    std::shared_ptr<Base> (*build_shared)() = nullptr;
+    std::shared_ptr<Base> (*build_shared_pmr)(std::pmr::memory_resource * resource) = nullptr;
+    Base * (*build_pmr)(std::pmr::memory_resource * resource) = nullptr;
+    void (*destroy_pmr)(Base * ptr, std::pmr::memory_resource * resource) = nullptr;
+    shared::builder::block_t<Base> (*build_block)(std::size_t count) = nullptr;
+    Base * (*build_pooled)() = nullptr;
+    void (*recycle)(Base * ptr) = nullptr;
+    const shared::builder::type_ops_t<Base> * ops = nullptr;
+    
+    builder_t() = default;
+    
+    // The old Base * (*)() builders. Only "build" is set: build_shared and
+    // build_pooled use it with global new, the other builds return nothing.
+    builder_t(Base * (*fn)()) : build(fn) {}
+    
+    // Builds with global new, like the old Base * (*)() builders
+    Base * operator ()() const {
+        return build();
+    }
+    
+    // False if default constructed (the builder was not found)
+    explicit operator bool() const {
+        return build != nullptr;
+    }
+    
+    friend bool operator ==(const builder_t &, const builder_t &) = default;
+    
+    // Same as the old function pointers, "builder != nullptr"
+    friend bool operator ==(const builder_t & builder, std::nullptr_t) {
+        return builder.build == nullptr;
+    }
+};
+
+// The builder of Derived objects
+template <typename Base, typename Derived>
+inline constexpr shared::builder::builder_t<Base> make_builder_fns() {
+    shared::builder::builder_t<Base> builder;
+    
+    builder.build            = &shared::builder::default_builder<Base, Derived>;
+    builder.build_shared     = &shared::builder::default_shared_builder<Base, Derived>;
+    builder.build_shared_pmr = &shared::builder::default_shared_pmr_builder<Base, Derived>;
+    builder.build_pmr        = &shared::builder::default_pmr_builder<Base, Derived>;
+    builder.destroy_pmr      = &shared::builder::default_pmr_destroyer<Base, Derived>;
+    builder.build_block      = &shared::builder::default_block_builder<Base, Derived>;
+    builder.build_pooled     = &shared::builder::default_pooled_builder<Base, Derived>;
+    builder.recycle          = &shared::builder::default_recycler<Base, Derived>;
+    builder.ops              = &shared::builder::type_ops<Base, Derived>;
+    
+    return builder;
+}
+
+// Deleter of the objects built from a memory resource,
+// returns the memory to the resource it came from
+template <typename Base>
+class pmr_deleter_t {
+public:
+    pmr_deleter_t() = default;
+    
+    pmr_deleter_t(
+        void (*destroyer)(Base * ptr, std::pmr::memory_resource * resource),
+        std::pmr::memory_resource * resource
+    ) :
+        destroyer_(destroyer),
+        resource_(resource)
+    {}
+    
+    void operator ()(Base * ptr) const {
+        destroyer_(ptr, resource_);
+    }
+    
+    std::pmr::memory_resource * resource() const {
+        return resource_;
+    }
+    
+private:
+    void (*destroyer_)(Base * ptr, std::pmr::memory_resource * resource) = nullptr;
+    std::pmr::memory_resource * resource_ = nullptr;
+};
+
+template <typename Base>
+using pmr_unique_ptr = std::unique_ptr<Base, shared::builder::pmr_deleter_t<Base>>;
+
+// Deleter of the pooled objects, returns them to the pool of the
+// thread deleting them
+template <typename Base>
+class pool_deleter_t {
+public:
+    pool_deleter_t() = default;
+    
+    explicit pool_deleter_t(void (*recycler)(Base * ptr)) : recycler_(recycler) {}
+    
+    void operator ()(Base * ptr) const {
+        recycler_(ptr);
+    }
+    
+private:
+    void (*recycler_)(Base * ptr) = nullptr;
+};
+
+template <typename Base>
+using pooled_ptr = std::unique_ptr<Base, shared::builder::pool_deleter_t<Base>>;
+
+// Owns objects built by shared::build_n, stored contiguously.
+// Iterating yields Base *, walking the block with a fixed stride.
+// All objects are destroyed together, with a single deallocation.
+template <typename Base>
+class batch_t {
+public:
+    class iterator {
+    public:
+        // Dereferencing returns a Base * by value, which C++20 iterators allow.
+        // The legacy forward iterators require a reference, so for them it's an input iterator.
+        using iterator_concept = std::random_access_iterator_tag;
+        using iterator_category = std::input_iterator_tag;
+        using value_type = Base *;
+        using difference_type = std::ptrdiff_t;
+        using reference = Base *;
+        
+        iterator() = default;
+        iterator(std::byte * ptr, const std::size_t stride) : ptr_(ptr), stride_(stride) {}
+        
+        Base * operator *() const {
+            return reinterpret_cast<Base *>(ptr_);
+        }
+        
+        Base * operator [](const difference_type n) const {
+            return *(*this + n);
+        }
+        
+        iterator & operator ++() { ptr_ += stride_; return *this; }
+        iterator & operator --() { ptr_ -= stride_; return *this; }
+        iterator operator ++(int) { iterator old = *this; ++*this; return old; }
+        iterator operator --(int) { iterator old = *this; --*this; return old; }
+        
+        iterator & operator +=(const difference_type n) { ptr_ += n * difference_type(stride_); return *this; }
+        iterator & operator -=(const difference_type n) { ptr_ -= n * difference_type(stride_); return *this; }
+        
+        friend iterator operator +(iterator it, const difference_type n) { return it += n; }
+        friend iterator operator +(const difference_type n, iterator it) { return it += n; }
+        friend iterator operator -(iterator it, const difference_type n) { return it -= n; }
+        
+        friend difference_type operator -(const iterator & lhs, const iterator & rhs) {
+            return lhs.stride_ != 0 ? (lhs.ptr_ - rhs.ptr_) / difference_type(lhs.stride_) : 0;
+        }
+        
+        friend bool operator ==(const iterator & lhs, const iterator & rhs) { return lhs.ptr_ == rhs.ptr_; }
+        friend auto operator <=>(const iterator & lhs, const iterator & rhs) { return lhs.ptr_ <=> rhs.ptr_; }
+        
+    private:
+        // Points to the Base inside the current object
+        std::byte * ptr_ = nullptr;
+        std::size_t stride_ = 0;
+    };
+    
+    batch_t() = default;
+    
+    explicit batch_t(const shared::builder::block_t<Base> & block) : block_(block) {}
+    
+    batch_t(batch_t && other) noexcept : block_(std::exchange(other.block_, {})) {}
+    
+    batch_t & operator =(batch_t && other) noexcept {
+        if(this != &other) {
+            this->clear();
+            block_ = std::exchange(other.block_, {});
+        }
+        
+        return *this;
+    }
+    
+    ~batch_t() {
+        this->clear();
+    }
+    
+    // Destroys every object
+    void clear() {
+        if(block_.destroy != nullptr) {
+            block_.destroy(block_.data, block_.count);
+        }
+        
+        block_ = {};
+    }
+    
+    iterator begin() const {
+        return iterator(block_.data + block_.base_offset, block_.stride);
+    }
+    
+    iterator end() const {
+        return this->begin() + std::ptrdiff_t(block_.count);
+    }
+    
+    Base * operator [](const std::size_t index) const {
+        return this->begin()[std::ptrdiff_t(index)];
+    }
+    
+    std::size_t size() const {
+        return block_.count;
+    }
+    
+    bool empty() const {
+        return block_.count == 0;
+    }
+    
+    // Bytes between two consecutive objects, sizeof(Derived)
+    std::size_t stride() const {
+        return block_.stride;
+    }
+    
+private:
+    shared::builder::block_t<Base> block_;
+};
+
 } // namespace shared::builder
 
 
@@ -42,19 +492,19 @@ inline Base * default_builder() {
 namespace shared {
 
 template <typename Base>
-using builder_type = Base * (*)();
+using builder_type = shared::builder::builder_t<Base>;
 
 // Creates a var builder.
 // Deletes any variable with the same key but different type.
 // If a variable with the same key and types exists, the var_view_t
 // will point to the existing var and will not overwrite the value.
 template <typename Base, typename Derived = Base, typename Map, typename Key = typename Map::key_type>
-inline shared::var_view_t<shared::builder_type<Base>, Key> make_builder(
+inline shared::var_view_t<shared::builder_type<Base>, Map> make_builder(
     Map & mp, 
     const std::type_identity_t<Key> & key
 ) {
     // Add the builder to the list
-    return shared::make_var<shared::builder_type<Base>>(mp, key, &shared::builder::default_builder<Base, Derived>);
+    return shared::make_var<shared::builder_type<Base>>(mp, key, shared::builder::make_builder_fns<Base, Derived>());
 }
 
 // If the object builder exists, build an object, otherwise returns a nullptr.
@@ -63,7 +513,7 @@ inline Base * build(Map & mp, const std::type_identity_t<Key> & key) {
     // Find the builder
     shared::builder_type<Base> builder = shared::get<shared::builder_type<Base>>(mp, key);
     
-    if(builder != nullptr) {
+    if(builder) {
         // And build
         return builder();
     }
@@ -80,12 +530,377 @@ inline std::unique_ptr<Base> build_unique(Map & mp, const std::type_identity_t<K
 }
 
 // If the object builder exists, build an object, otherwise returns a nullptr.
+// The object and the control block share a single allocation.
 template <typename Base, typename Map, typename Key = typename Map::key_type>
 inline std::shared_ptr<Base> build_shared(Map & mp, const std::type_identity_t<Key> & key) {
-    return std::shared_ptr<Base>(shared::build<Base>(mp, key));
+    shared::builder_type<Base> builder = shared::get<shared::builder_type<Base>>(mp, key);
+    
+    if(builder.build_shared != nullptr) {
+        return builder.build_shared();
+    }
+    else if(builder) {
+        // Builders from plain function pointers
+        return std::shared_ptr<Base>(builder());
+    }
+    else {
+        return nullptr;
+    }
+}
+
+// If the object builder exists, build an object in memory from "resource",
+// otherwise returns a nullptr (also for builders from plain function pointers).
+// The deleter returns the memory to "resource".
+template <typename Base, typename Map, typename Key = typename Map::key_type>
+inline shared::builder::pmr_unique_ptr<Base> build_unique(
+    Map & mp,
+    const std::type_identity_t<Key> & key,
+    std::pmr::memory_resource * resource
+) {
+    shared::builder_type<Base> builder = shared::get<shared::builder_type<Base>>(mp, key);
+    
+    if(builder.build_pmr != nullptr) {
+        return shared::builder::pmr_unique_ptr<Base>(
+            builder.build_pmr(resource),
+            shared::builder::pmr_deleter_t<Base>(builder.destroy_pmr, resource)
+        );
+    }
+    else {
+        return nullptr;
+    }
+}
+
+// If the object builder exists, build an object in memory from "resource",
+// otherwise returns a nullptr (also for builders from plain function pointers).
+// The object and the control block share a single allocation.
+template <typename Base, typename Map, typename Key = typename Map::key_type>
+inline std::shared_ptr<Base> build_shared(
+    Map & mp,
+    const std::type_identity_t<Key> & key,
+    std::pmr::memory_resource * resource
+) {
+    shared::builder_type<Base> builder = shared::get<shared::builder_type<Base>>(mp, key);
+    return builder.build_shared_pmr != nullptr ? builder.build_shared_pmr(resource) : nullptr;
+}
+
+// If the object builder exists, reuse a free object of the Derived type,
+// building one only if the pool of this thread is empty,
+// otherwise returns a nullptr.
+// The deleter resets the object and returns it to the pool.
+template <typename Base, typename Map, typename Key = typename Map::key_type>
+inline shared::builder::pooled_ptr<Base> build_pooled(Map & mp, const std::type_identity_t<Key> & key) {
+    shared::builder_type<Base> builder = shared::get<shared::builder_type<Base>>(mp, key);
+    
+    if(builder.build_pooled != nullptr) {
+        return shared::builder::pooled_ptr<Base>(
+            builder.build_pooled(),
+            shared::builder::pool_deleter_t<Base>(builder.recycle)
+        );
+    }
+    else if(builder) {
+        // Builders from plain function pointers have no pool
+        return shared::builder::pooled_ptr<Base>(
+            builder(),
+            shared::builder::pool_deleter_t<Base>(&shared::builder::default_deleter<Base>)
+        );
+    }
+    else {
+        return nullptr;
+    }
+}
+
+// If the object builder exists, build "count" objects in a single block,
+// otherwise returns an empty batch (also for builders from plain function pointers).
+template <typename Base, typename Map, typename Key = typename Map::key_type>
+inline shared::builder::batch_t<Base> build_n(
+    Map & mp,
+    const std::type_identity_t<Key> & key,
+    const std::size_t count
+) {
+    shared::builder_type<Base> builder = shared::get<shared::builder_type<Base>>(mp, key);
+    
+    if(builder.build_block != nullptr) {
+        return shared::builder::batch_t<Base>(builder.build_block(count));
+    }
+    else {
+        return shared::builder::batch_t<Base>();
+    }
 }
 
 } // namespace shared
 
 
+// module namespace
+namespace shared::builder {
+
+// Builds a Base object from the arguments "Args".
+// The state (a callable receiving Args) is stored in a small buffer
+// inside the builder, so it is copied with the var, without heap allocation
+// nor the std::function type erasure.
+// The type in the map is arg_builder_t<Base, Args...>,
+// builders with other Args are other types.
+template <typename Base, typename... Args>
+class arg_builder_t {
+public:
+    // Bigger states do not compile, store a pointer to them instead
+    static constexpr std::size_t buffer_size = 4 * sizeof(void *);
+    
+    arg_builder_t() = default;
+    
+    // "fn(args...)" must return a Base * (or a pointer to a derived type)
+    template <typename Fn>
+    requires (!std::is_same_v<std::remove_cvref_t<Fn>, arg_builder_t>)
+    explicit arg_builder_t(Fn && fn) {
+        using state_type = std::remove_cvref_t<Fn>;
+        
+        static_assert(sizeof(state_type) <= buffer_size, "the builder state does not fit the buffer");
+        static_assert(alignof(state_type) <= alignof(std::max_align_t), "the builder state is overaligned");
+        static_assert(std::is_invocable_r_v<Base *, const state_type &, Args...>, "the builder cannot be called with Args");
+        
+        std::construct_at(reinterpret_cast<state_type *>(buffer_), std::forward<Fn>(fn));
+        
+        invoke_ = [](const void * state, Args... args) -> Base * {
+            return (*reinterpret_cast<const state_type *>(state))(std::forward<Args>(args)...);
+        };
+        
+        if constexpr(!std::is_trivially_copyable_v<state_type>) {
+            copy_ = [](void * dest, const void * src) {
+                std::construct_at(reinterpret_cast<state_type *>(dest), *reinterpret_cast<const state_type *>(src));
+            };
+            
+            destroy_ = [](void * state) {
+                std::destroy_at(reinterpret_cast<state_type *>(state));
+            };
+        }
+    }
+    
+    arg_builder_t(const arg_builder_t & other) {
+        this->copy_from(other);
+    }
+    
+    arg_builder_t & operator =(const arg_builder_t & other) {
+        if(this != &other) {
+            this->reset();
+            this->copy_from(other);
+        }
+        
+        return *this;
+    }
+    
+    ~arg_builder_t() {
+        this->reset();
+    }
+    
+    Base * operator ()(Args... args) const {
+        return invoke_(buffer_, std::forward<Args>(args)...);
+    }
+    
+    // False if default constructed (the builder was not found)
+    explicit operator bool() const {
+        return invoke_ != nullptr;
+    }
+    
+private:
+    alignas(std::max_align_t) std::byte buffer_[buffer_size] = {};
+    
+    Base * (*invoke_)(const void * state, Args... args) = nullptr;
+    
+    // Both nullptr if the state is trivially copyable
+    void (*copy_)(void * dest, const void * src) = nullptr;
+    void (*destroy_)(void * state) = nullptr;
+    
+    void copy_from(const arg_builder_t & other) {
+        if(other.copy_ != nullptr) {
+            other.copy_(buffer_, other.buffer_);
+        }
+        else {
+            std::memcpy(buffer_, other.buffer_, buffer_size);
+        }
+        
+        invoke_  = other.invoke_;
+        copy_    = other.copy_;
+        destroy_ = other.destroy_;
+    }
+    
+    void reset() {
+        if(destroy_ != nullptr) {
+            destroy_(buffer_);
+        }
+        
+        invoke_  = nullptr;
+        copy_    = nullptr;
+        destroy_ = nullptr;
+    }
+};
+
+// Constructs a Derived object from the arguments
+template <typename Base, typename Derived, typename... Args>
+struct constructor_t {
+    Base * operator ()(Args... args) const {
+        return new Derived(std::forward<Args>(args)...);
+    }
+};
+
+} // namespace shared::builder
+
+
+// The lib namespace
+namespace shared {
+
+template <typename Base, typename... Args>
+using arg_builder_type = shared::builder::arg_builder_t<Base, Args...>;
+
+// Creates a builder calling the constructor Derived(Args...).
+// Like make_builder, keeps an existing builder with the same key and types.
+template <typename Base, typename Derived, typename... Args, typename Map, typename Key = typename Map::key_type>
+inline shared::var_view_t<shared::arg_builder_type<Base, Args...>, Map> make_arg_builder(
+    Map & mp,
+    const std::type_identity_t<Key> & key
+) {
+    return shared::make_var<shared::arg_builder_type<Base, Args...>>(
+        mp,
+        key,
+        shared::arg_builder_type<Base, Args...>(shared::builder::constructor_t<Base, Derived, Args...>())
+    );
+}
+
+// Creates a builder calling "fn(args...)", "fn" may carry state (like a lambda capture).
+// Overwrites the state of an existing builder with the same key and types.
+template <typename Base, typename... Args, typename Map, typename Key = typename Map::key_type, typename Fn>
+inline shared::var_view_t<shared::arg_builder_type<Base, Args...>, Map> make_arg_builder_from(
+    Map & mp,
+    const std::type_identity_t<Key> & key,
+    Fn && fn
+) {
+    shared::arg_builder_type<Base, Args...> builder(std::forward<Fn>(fn));
+    
+    auto view = shared::make_var<shared::arg_builder_type<Base, Args...>>(mp, key);
+    view = builder;
+    return view;
+}
+
+// If the builder taking Args exists, build an object, otherwise returns a nullptr.
+// Args must be explicit, they select the builder type:
+// shared::build_with<Base, int>(map, key, 42)
+template <typename Base, typename... Args, typename Map, typename Key = typename Map::key_type>
+inline Base * build_with(
+    Map & mp,
+    const std::type_identity_t<Key> & key,
+    std::type_identity_t<Args>... args
+) {
+    using builder_type = shared::arg_builder_type<Base, Args...>;
+    
+    auto it = mp.find(key);
+    
+    // Builders of other Args have the same key but not the same type
+    if(it != mp.end() && shared::impl::are_types_equal<builder_type>(it->second)) {
+        const builder_type & builder = *shared::impl::info_to_data_ptr<builder_type>(it->second);
+        return builder ? builder(std::forward<Args>(args)...) : nullptr;
+    }
+    else {
+        return nullptr;
+    }
+}
+
+// If the builder taking Args exists, build an object, otherwise returns a nullptr.
+template <typename Base, typename... Args, typename Map, typename Key = typename Map::key_type>
+inline std::unique_ptr<Base> build_unique_with(
+    Map & mp,
+    const std::type_identity_t<Key> & key,
+    std::type_identity_t<Args>... args
+) {
+    return std::unique_ptr<Base>(shared::build_with<Base, Args...>(mp, key, std::forward<Args>(args)...));
+}
+
+} // namespace shared
+
+
+// module namespace
+namespace shared::builder {
+
+// Dense index of a builder in a registry
+using builder_id_t = std::uint32_t;
+
+// Resolves builder keys once to dense ids.
+// Building from an id is a single indirect call,
+// without the key lookup done by shared::build.
+// An id keeps the builder resolved at the time,
+// later changes to the builder var are not seen.
+template <typename Base>
+class registry_t {
+public:
+    using builder_type = shared::builder_type<Base>;
+    
+    static constexpr builder_id_t invalid_id = ~builder_id_t(0);
+    
+    // Finds the builder "key", returns its id or invalid_id if
+    // there is no builder of Base with this key.
+    // The same builder always gets the same id.
+    template <typename Map, typename Key = typename Map::key_type>
+    builder_id_t resolve(Map & mp, const std::type_identity_t<Key> & key) {
+        auto it_var = mp.find(key);
+        
+        // A single lookup, then the type check
+        if(it_var == mp.end() || !shared::impl::are_types_equal<builder_type>(it_var->second)) {
+            return invalid_id;
+        }
+        
+        const builder_type & builder = *shared::impl::info_to_data_ptr<builder_type>(it_var->second);
+        
+        if(!builder) {
+            return invalid_id;
+        }
+        
+        // Every Derived type has its own build function
+        auto [it, is_new] = ids_.try_emplace(builder.build, builder_id_t(builders_.size()));
+        
+        if(is_new) {
+            builders_.push_back(builder);
+        }
+        
+        return it->second;
+    }
+    
+    // Builds an object, "id" must be valid
+    Base * build(const builder_id_t id) const {
+        return builders_[id]();
+    }
+    
+    // Builds an object, "id" must be valid
+    std::unique_ptr<Base> build_unique(const builder_id_t id) const {
+        return std::unique_ptr<Base>(this->build(id));
+    }
+    
+    // Builds an object, "id" must be valid
+    std::shared_ptr<Base> build_shared(const builder_id_t id) const {
+        const builder_type & builder = builders_[id];
+        
+        // Builders from plain function pointers only have "build"
+        if(builder.build_shared == nullptr) {
+            return std::shared_ptr<Base>(builder());
+        }
+        
+        return builder.build_shared();
+    }
+    
+    // The builder with the id "id"
+    builder_type get(const builder_id_t id) const {
+        return builders_[id];
+    }
+    
+    // How many builders were resolved
+    std::size_t size() const {
+        return builders_.size();
+    }
+    
+private:
+    // Indexed by id
+    std::vector<builder_type> builders_;
+    
+    // Only used by resolve
+    std::map<Base * (*)(), builder_id_t> ids_;
+};
+
+} // namespace shared::builder
+
+
 #endif // SHARED_VAR_LIB__SHARED_BUILDER_HPP
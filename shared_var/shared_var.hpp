@@ -32,4 +32,6 @@ limitations under the License.
 
 #include "map_holder.hpp"
 
+#include "extern_templates.hpp"
+
 #endif // SHARED_VAR_LIB__SHARED_VAR_HPP
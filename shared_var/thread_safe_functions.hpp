@@ -145,6 +145,49 @@ inline void isolate(
     shared::isolate(mp, key);
 }
 
+// Registers an observer of the var "key".
+// Returns false if the var doesn't exist.
+template <typename Map, typename Key = typename Map::key_type>
+inline bool observe(
+    Map & mp, 
+    const std::type_identity_t<Key> & key,
+    const typename shared::observer_t<Key>::callback_type callback,
+    void * context = nullptr
+) {
+    using lock_type = typename Map::write_guard_type;
+    
+    lock_type lock(mp.mutex());
+    return shared::observe(mp, key, callback, context);
+}
+
+// Unregisters an observer of the var "key"
+template <typename Map, typename Key = typename Map::key_type>
+inline void unobserve(
+    Map & mp, 
+    const std::type_identity_t<Key> & key,
+    const typename shared::observer_t<Key>::callback_type callback,
+    void * context = nullptr
+) {
+    using lock_type = typename Map::write_guard_type;
+    
+    lock_type lock(mp.mutex());
+    shared::unobserve(mp, key, callback, context);
+}
+
+// Tells the observers the var "key" has changed.
+// The observers are called with the map locked.
+template <typename Map, typename Key = typename Map::key_type>
+inline void notify(
+    Map & mp, 
+    const std::type_identity_t<Key> & key
+) {
+    // Write: the observer lists may change
+    using lock_type = typename Map::write_guard_type;
+    
+    lock_type lock(mp.mutex());
+    shared::notify(mp, key);
+}
+
 // Finds whether an element with the given key and type exists
 template <typename T, typename Map, typename Key = typename Map::key_type>
 inline shared::exists_t exists(
@@ -197,7 +240,7 @@ inline T get(
 // Searches the map for the key, if the key is found the value is set.
 template <shared::storable T, typename Map, typename Key = typename Map::key_type, shared::assignable_to<T> Value>
 inline void set(
-    const Map & mp, 
+    Map & mp, 
     const std::type_identity_t<Key> & key,
     Value && value
 ) {
@@ -205,7 +248,7 @@ inline void set(
     using lock_type = typename Map::read_guard_type;
     
     lock_type lock(mp.mutex());
-    shared::set<T>(mp, key, std::forward<T>(value));
+    shared::set<T>(mp, key, std::forward<Value>(value));
 }
 
 } // namespace shared::thread_safe
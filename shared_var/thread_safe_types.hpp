@@ -61,8 +61,13 @@ public:
     
     using mutex_type = std::shared_mutex;
     
+#ifdef SHARED_VAR_INSTRUMENTATION
+    using read_guard_type = shared::instrumentation::timed_lock_t<std::shared_lock<mutex_type>>;
+    using write_guard_type = shared::instrumentation::timed_lock_t<std::unique_lock<mutex_type>>;
+#else
     using read_guard_type = std::shared_lock<mutex_type>;
     using write_guard_type = std::unique_lock<mutex_type>;
+#endif
     
 // ==== custom constructors and assignment operators ====
     
@@ -118,6 +123,18 @@ public:
         return map_.find(key);
     }
     
+    // Same as std::map::lower_bound
+    template <typename K>
+    iterator lower_bound(const K & key) {
+        return map_.lower_bound(key);
+    }
+    
+    // Same as std::map::lower_bound
+    template <typename K>
+    const_iterator lower_bound(const K & key) const {
+        return map_.lower_bound(key);
+    }
+    
     // Same as std::map::size
     size_type size() const noexcept {
         return map_.size();
@@ -163,10 +180,44 @@ public:
         return mutex_;
     }
     
+    // Allows read locks on const maps
+    std::shared_mutex & mutex() const {
+        return mutex_;
+    }
+    
+// ==== observers ====
+    
+    // Observers of every var in the map
+    std::vector<shared::observer_t<Key>> & observers() noexcept {
+        return observers_;
+    }
+    
+    const std::vector<shared::observer_t<Key>> & observers() const noexcept {
+        return observers_;
+    }
+    
+#ifdef SHARED_VAR_INSTRUMENTATION
+    // Called by the lookups, see shared::instrumentation::key_profiler_t
+    shared::instrumentation::lookup_hook_t<Key> & lookup_hook() noexcept {
+        return lookup_hook_;
+    }
+    
+    const shared::instrumentation::lookup_hook_t<Key> & lookup_hook() const noexcept {
+        return lookup_hook_;
+    }
+#endif
+    
 private:
     // The real map
     storage_type map_;
     
+    // Map-wide observers, fired after the per-var observers
+    std::vector<shared::observer_t<Key>> observers_;
+    
+#ifdef SHARED_VAR_INSTRUMENTATION
+    shared::instrumentation::lookup_hook_t<Key> lookup_hook_;
+#endif
+    
     // 2 levels of thread access
     mutable std::shared_mutex mutex_;
 };
@@ -284,6 +284,47 @@ public:
         key_ = Key();
     }
     
+    // The var name
+    constexpr const Key & key() const {
+        return key_;
+    }
+    
+    // The map containing the var
+    constexpr Map * map() const {
+        return map_;
+    }
+    
+// ==== observers ====
+    
+    // Tells the var observers the value has changed
+    void notify() {
+        if(map_ != nullptr) {
+            shared::thread_safe::notify(*map_, key_);
+        }
+    }
+    
+    // Assigns the value, then tells the var observers.
+    // Plain assignments don't notify, coroutines waiting with
+    // shared::coro::changed or shared::coro::until are resumed by this one.
+    // The write and the notification hold the same lock,
+    // so the observers see this value.
+    template <shared::assignable_to<T> Value>
+    shared::thread_safe::ts_var_view_t<T, Map> & set_and_notify(Value && value) {
+        using lock_type = typename Map::write_guard_type;
+        lock_type lock(map_->mutex());
+        
+        // If move operations are available, use them
+        if constexpr(std::is_move_assignable<T>::value) {
+            *data_ptr_ = std::forward<Value>(value);
+        }
+        else {
+            *data_ptr_ = value;
+        }
+        
+        shared::notify(*map_, key_);
+        return *this;
+    }
+    
 private:
 // ==== internal vars ====
     
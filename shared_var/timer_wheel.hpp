@@ -0,0 +1,248 @@
+#ifndef SHARED_VAR_LIB__TIMER_WHEEL_HPP
+#define SHARED_VAR_LIB__TIMER_WHEEL_HPP
+
+/* Shared Variable Library
+ * Timer wheel
+ * Author:  Yago T. de Mello
+ * e-mail:  yago.t.mello@gmail.com
+ * Version: 2.11.0 2022-07-09
+ * License: Apache 2.0
+ * C++20
+ */
+
+/*
+Copyright 2022 Yago Teodoro de Mello
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+    http://www.apache.org/licenses/LICENSE-2.0
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+// std::max
+#include <algorithm>
+
+// the wheel levels are std::arrays of slots
+#include <array>
+
+// default lib includes and definitions
+#include "includes.hpp"
+
+
+// module namespace
+namespace shared::timer {
+
+// Hierarchical timer wheel.
+// Scheduling and cancelling are O(1), advancing one tick is O(1) amortized.
+// Time is counted in ticks, the user decides how long a tick is and
+// moves the wheel with advance().
+// Not thread safe.
+class timer_wheel_t {
+public:
+    using tick_type = std::uint64_t;
+    using callback_type = void (*)(void * context);
+    
+    // Identifies a scheduled timer, used to cancel it
+    struct handle_t {
+        std::uint32_t index = ~std::uint32_t(0);
+        std::uint32_t generation = 0;
+    };
+    
+    // 4 levels of 64 slots cover 2^24 ticks,
+    // longer timers wait in the overflow list
+    static constexpr unsigned slot_bits = 6;
+    static constexpr std::size_t slot_count = std::size_t(1) << slot_bits;
+    static constexpr std::size_t level_count = 4;
+    
+    timer_wheel_t() = default;
+    
+    // Handles would point to the wrong wheel
+    timer_wheel_t(const timer_wheel_t &) = delete;
+    timer_wheel_t & operator =(const timer_wheel_t &) = delete;
+    
+    // Calls "callback(context)" after "delay" ticks (at least one)
+    handle_t schedule(const tick_type delay, const callback_type callback, void * context = nullptr) {
+        std::uint32_t index;
+        
+        // Reuse a free node when possible
+        if(!free_.empty()) {
+            index = free_.back();
+            free_.pop_back();
+        }
+        else {
+            index = std::uint32_t(nodes_.size());
+            nodes_.emplace_back();
+        }
+        
+        node_t & node = nodes_[index];
+        node.deadline  = now_ + std::max<tick_type>(delay, 1);
+        node.callback  = callback;
+        node.context   = context;
+        node.is_active = true;
+        
+        const handle_t handle = {index, node.generation};
+        this->insert(handle);
+        active_count_++;
+        
+        return handle;
+    }
+    
+    // Cancels a timer. Returns false if it has already fired or was cancelled.
+    bool cancel(const handle_t handle) {
+        if(!this->is_scheduled(handle)) return false;
+        
+        // The slot entry becomes stale and is dropped when its slot is processed
+        this->release(handle.index);
+        return true;
+    }
+    
+    // True if the timer has not fired nor was cancelled
+    bool is_scheduled(const handle_t handle) const {
+        return
+            handle.index < nodes_.size() &&
+            nodes_[handle.index].is_active &&
+            nodes_[handle.index].generation == handle.generation;
+    }
+    
+    // Moves the wheel "ticks" ticks forward, firing the expired timers.
+    // Returns how many timers were fired.
+    std::size_t advance(tick_type ticks) {
+        std::size_t fired = 0;
+        
+        while(ticks > 0) {
+            // Nothing to fire, jump
+            if(active_count_ == 0) {
+                now_ += ticks;
+                break;
+            }
+            
+            now_++;
+            ticks--;
+            
+            this->cascade();
+            fired += this->fire(levels_[0][now_ & slot_mask]);
+        }
+        
+        return fired;
+    }
+    
+    // Moves the wheel to the tick "tick", if it is in the future
+    std::size_t advance_to(const tick_type tick) {
+        return tick > now_ ? this->advance(tick - now_) : 0;
+    }
+    
+    // The current tick
+    tick_type now() const {
+        return now_;
+    }
+    
+    // How many timers are scheduled
+    std::size_t size() const {
+        return active_count_;
+    }
+    
+private:
+    static constexpr tick_type slot_mask = slot_count - 1;
+    
+    struct node_t {
+        tick_type deadline = 0;
+        callback_type callback = nullptr;
+        void * context = nullptr;
+        std::uint32_t generation = 0;
+        bool is_active = false;
+    };
+    
+    using slot_type = std::vector<handle_t>;
+    
+    std::array<std::array<slot_type, slot_count>, level_count> levels_;
+    slot_type overflow_;
+    
+    std::vector<node_t> nodes_;
+    std::vector<std::uint32_t> free_;
+    
+    tick_type now_ = 0;
+    std::size_t active_count_ = 0;
+    
+    // Puts the timer in the level matching its distance to the deadline
+    void insert(const handle_t handle) {
+        const tick_type deadline = nodes_[handle.index].deadline;
+        const tick_type delta = deadline - now_;
+        
+        for(std::size_t level = 0; level < level_count; level++) {
+            const unsigned shift = unsigned(slot_bits * level);
+            
+            if(delta < (tick_type(1) << (shift + slot_bits))) {
+                levels_[level][(deadline >> shift) & slot_mask].push_back(handle);
+                return;
+            }
+        }
+        
+        overflow_.push_back(handle);
+    }
+    
+    // Moves the timers of the upper levels closer to level 0
+    // every time a lower level completes a turn
+    void cascade() {
+        for(std::size_t level = 1; level < level_count; level++) {
+            const unsigned shift = unsigned(slot_bits * level);
+            
+            // The lower level has not completed a turn
+            if((now_ & ((tick_type(1) << shift) - 1)) != 0) return;
+            
+            this->reinsert(levels_[level][(now_ >> shift) & slot_mask]);
+        }
+        
+        // Every level completed a turn
+        if((now_ & ((tick_type(1) << (slot_bits * level_count)) - 1)) == 0) {
+            this->reinsert(overflow_);
+        }
+    }
+    
+    void reinsert(slot_type & slot) {
+        slot_type pending;
+        pending.swap(slot);
+        
+        for(const handle_t handle : pending) {
+            if(this->is_scheduled(handle)) {
+                this->insert(handle);
+            }
+        }
+    }
+    
+    std::size_t fire(slot_type & slot) {
+        // The callbacks may schedule new timers
+        slot_type pending;
+        pending.swap(slot);
+        
+        std::size_t fired = 0;
+        
+        for(const handle_t handle : pending) {
+            if(!this->is_scheduled(handle)) continue;
+            
+            const node_t node = nodes_[handle.index];
+            this->release(handle.index);
+            
+            node.callback(node.context);
+            fired++;
+        }
+        
+        return fired;
+    }
+    
+    void release(const std::uint32_t index) {
+        node_t & node = nodes_[index];
+        node.is_active = false;
+        node.generation++;
+        free_.push_back(index);
+        active_count_--;
+    }
+};
+
+} // namespace shared::timer
+
+
+#endif // SHARED_VAR_LIB__TIMER_WHEEL_HPP
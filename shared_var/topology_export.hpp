@@ -0,0 +1,255 @@
+#ifndef SHARED_VAR_LIB__TOPOLOGY_EXPORT_HPP
+#define SHARED_VAR_LIB__TOPOLOGY_EXPORT_HPP
+
+/* Shared Variable Library
+ * Topology export
+ * Author:  Yago T. de Mello
+ * e-mail:  yago.t.mello@gmail.com
+ * Version: 2.11.0 2022-07-09
+ * License: Apache 2.0
+ * C++20
+ */
+
+/*
+Copyright 2022 Yago Teodoro de Mello
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+    http://www.apache.org/licenses/LICENSE-2.0
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+// std::optional filters
+#include <optional>
+
+// std::ostream
+#include <ostream>
+
+// the lib
+#include "shared_var.hpp"
+
+// text helpers shared with shared::debug::dump
+#include "debug_tools.hpp"
+
+
+// module namespace
+namespace shared::debug {
+
+// Output formats of shared::debug::export_topology
+enum topology_format_t : uint_fast8_t {
+    // Graphviz undirected graph, one node per var and one edge per ref
+    TOPOLOGY_DOT        = 0,
+    // One JSON object per line:
+    // {"node", "group", "type", "views", "observers"} or {"edge": [a, b]}
+    TOPOLOGY_JSON_LINES = 1
+};
+
+// Which vars are exported, every var if both are empty
+template <typename Key>
+struct topology_filter_t {
+    // Only the vars bound to the var with this key, itself included
+    std::optional<Key> group;
+    
+    // Only the vars with keys starting with this prefix
+    std::optional<Key> prefix;
+};
+
+} // namespace shared::debug
+
+
+// Internal use
+namespace shared::debug::impl {
+
+// Bytes buffered before writing to the stream
+inline constexpr std::size_t topology_buffer_size = 64 * 1024;
+
+// "group_ptr" is the value of the filter group,
+// groups may share the id, not the value
+template <typename Key>
+inline bool is_selected(const shared::info_t<Key> & info, const shared::debug::topology_filter_t<Key> & filter, const void * group_ptr) {
+    if(filter.group.has_value() && info.ptr.get() != group_ptr) {
+        return false;
+    }
+    
+    if constexpr(requires (const Key & key) { key.starts_with(key); }) {
+        if(filter.prefix.has_value() && !info.key.starts_with(*filter.prefix)) {
+            return false;
+        }
+    }
+    
+    return true;
+}
+
+template <typename Key>
+inline void append_node(std::string & out, std::string & scratch, const shared::info_t<Key> & info, const shared::debug::topology_format_t format) {
+    if(format == shared::debug::TOPOLOGY_DOT) {
+        // DOT strings use the same escapes as JSON
+        scratch.clear();
+        shared::impl::default_formatter<Key>(scratch, &info.key);
+        out += "  ";
+        shared::debug::impl::append_json_string(out, scratch);
+        
+        // Escaped to "\n", a line break in DOT labels
+        scratch += '\n';
+        scratch += info.type_id->name();
+        out += " [label=";
+        shared::debug::impl::append_json_string(out, scratch);
+        
+        scratch.clear();
+        shared::impl::default_formatter<Key>(scratch, &info.group_id);
+        out += ", group=";
+        shared::debug::impl::append_json_string(out, scratch);
+        
+        const std::size_t views = info.pointers_to_var.size();
+        const std::size_t observers = info.observers.size();
+        
+        out += ", views=";
+        shared::impl::default_formatter<std::size_t>(out, &views);
+        out += ", observers=";
+        shared::impl::default_formatter<std::size_t>(out, &observers);
+        out += "];\n";
+    }
+    else {
+        out += "{\"node\":";
+        scratch.clear();
+        shared::impl::default_formatter<Key>(scratch, &info.key);
+        shared::debug::impl::append_json_string(out, scratch);
+        
+        out += ",\"group\":";
+        scratch.clear();
+        shared::impl::default_formatter<Key>(scratch, &info.group_id);
+        shared::debug::impl::append_json_string(out, scratch);
+        
+        out += ",\"type\":";
+        shared::debug::impl::append_json_string(out, info.type_id->name());
+        
+        const std::size_t views = info.pointers_to_var.size();
+        const std::size_t observers = info.observers.size();
+        
+        out += ",\"views\":";
+        shared::impl::default_formatter<std::size_t>(out, &views);
+        out += ",\"observers\":";
+        shared::impl::default_formatter<std::size_t>(out, &observers);
+        out += "}\n";
+    }
+}
+
+template <typename Key>
+inline void append_edge(std::string & out, std::string & scratch, const Key & lhs, const Key & rhs, const shared::debug::topology_format_t format) {
+    out += format == shared::debug::TOPOLOGY_DOT ? "  " : "{\"edge\":[";
+    
+    scratch.clear();
+    shared::impl::default_formatter<Key>(scratch, &lhs);
+    shared::debug::impl::append_json_string(out, scratch);
+    
+    out += format == shared::debug::TOPOLOGY_DOT ? " -- " : ",";
+    
+    scratch.clear();
+    shared::impl::default_formatter<Key>(scratch, &rhs);
+    shared::debug::impl::append_json_string(out, scratch);
+    
+    out += format == shared::debug::TOPOLOGY_DOT ? ";\n" : "]}\n";
+}
+
+} // namespace shared::debug::impl
+
+
+// module namespace
+namespace shared::debug {
+
+// Writes the vars and their refs to "stream".
+// Streams the map in key order with a fixed size buffer,
+// the memory used doesn't depend on the map size.
+// Refs are symmetric, each edge is written once. Edges to vars
+// outside the filter are kept, the other end appears without attributes.
+// Thread safe maps are read locked for the whole export.
+template <typename Map, typename Key = typename Map::key_type>
+requires shared::debug::impl::printable_key<Key>
+inline void export_topology(
+    const Map & map,
+    std::ostream & stream,
+    const shared::debug::topology_format_t format = shared::debug::TOPOLOGY_DOT,
+    const shared::debug::topology_filter_t<Key> & filter = {}
+) {
+    [[maybe_unused]] auto lock = shared::impl::read_lock_map(map);
+    
+    std::string out;
+    std::string scratch;
+    out.reserve(shared::debug::impl::topology_buffer_size + 1024);
+    
+    auto flush = [&](const bool force) {
+        if(force || out.size() >= shared::debug::impl::topology_buffer_size) {
+            stream.write(out.data(), std::streamsize(out.size()));
+            out.clear();
+        }
+    };
+    
+    if(format == shared::debug::TOPOLOGY_DOT) {
+        out += "graph shared {\n";
+    }
+    
+    // The map is ordered, the prefix is a contiguous range
+    auto it = map.begin();
+    
+    if constexpr(requires (const Key & key) { key.starts_with(key); }) {
+        if(filter.prefix.has_value()) {
+            it = map.lower_bound(*filter.prefix);
+        }
+    }
+    
+    // Found once, the group is compared by value
+    const void * group_ptr = nullptr;
+    
+    if(filter.group.has_value()) {
+        auto group_it = map.find(*filter.group);
+        
+        if(group_it != map.end()) {
+            group_ptr = group_it->second.ptr.get();
+        }
+        else {
+            // No such var, nothing is exported
+            it = map.end();
+        }
+    }
+    
+    for(; it != map.end(); ++it) {
+        const shared::info_t<Key> & info = it->second;
+        
+        if constexpr(requires (const Key & key) { key.starts_with(key); }) {
+            if(filter.prefix.has_value() && !info.key.starts_with(*filter.prefix)) break;
+        }
+        
+        if(!shared::debug::impl::is_selected(info, filter, group_ptr)) continue;
+        
+        shared::debug::impl::append_node(out, scratch, info, format);
+        flush(false);
+        
+        for(const Key & ref : info.refs) {
+            // The other end writes the edge, unless it is filtered out
+            if(ref < info.key) {
+                auto ref_it = map.find(ref);
+                if(ref_it != map.end() && shared::debug::impl::is_selected(ref_it->second, filter, group_ptr)) continue;
+            }
+            
+            shared::debug::impl::append_edge(out, scratch, info.key, ref, format);
+            
+            // A var may have many refs, the buffer stays bounded
+            flush(false);
+        }
+    }
+    
+    if(format == shared::debug::TOPOLOGY_DOT) {
+        out += "}\n";
+    }
+    
+    flush(true);
+}
+
+} // namespace shared::debug
+
+
+#endif // SHARED_VAR_LIB__TOPOLOGY_EXPORT_HPP
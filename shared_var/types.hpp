@@ -30,6 +30,42 @@ limitations under the License.
 // The lib namespace
 namespace shared {
 
+template <typename Key>
+struct info_t;
+
+// Describes why an observer was called
+enum event_t : uint_fast8_t {
+    VAR_CHANGED = 0,
+    VAR_REMOVED = 1
+};
+
+// A callback fired by shared::notify (and shared::remove) with the info of
+// the affected var. Returning false unregisters the observer.
+// Observers must not modify the map topology.
+template <typename Key>
+struct observer_t {
+    using callback_type = bool (*)(void * context, const shared::info_t<Key> & info, shared::event_t event);
+    
+    callback_type callback;
+    void * context;
+};
+
+// Size and alignment of a var type,
+// used to account memory and to copy vars without the copier
+struct layout_t {
+    std::size_t size;
+    std::size_t alignment;
+    bool is_trivially_copyable;
+};
+
+// One instance per type, stored in shared::info_t
+template <typename T>
+inline constexpr shared::layout_t layout_of = {
+    sizeof(T),
+    alignof(T),
+    std::is_trivially_copyable_v<T>
+};
+
 // Contains the shared var info
 template <typename Key>
 struct info_t {
@@ -38,6 +74,7 @@ struct info_t {
     using key_type = Key;
     using allocator_type = std::shared_ptr<void> (*)(void * ptr_to_value);
     using copier_type = void (*)(void * ptr_to_dest, void * ptr_to_src);
+    using formatter_type = void (*)(std::string & out, const void * ptr_to_value);
     
     std::shared_ptr<void> ptr; // The shared variable (pointer (and type erased))
     key_type group_id;         // The group where the variable is shared
@@ -45,8 +82,11 @@ struct info_t {
     const std::type_info * type_id; // The shared variable type (RTTI), used for type checking
     allocator_type allocator;  // Allocates memory when called
     copier_type copier;        // Copies the value of another var
+    formatter_type formatter = nullptr; // Appends the value as text, nullptr if T has no conversion
+    const shared::layout_t * layout = nullptr; // Size and alignment of the var type
     std::set<key_type> refs;   // Variables connected to this var
     std::set<void **> pointers_to_var; // Vars with direct access to the data pointer
+    std::vector<shared::observer_t<Key>> observers; // Called when the var changes
 };
 
 // Stores information about the shared variables 
@@ -120,6 +160,18 @@ public:
         return map_.find(key);
     }
     
+    // Same as std::map::lower_bound
+    template <typename K>
+    iterator lower_bound(const K & key) {
+        return map_.lower_bound(key);
+    }
+    
+    // Same as std::map::lower_bound
+    template <typename K>
+    const_iterator lower_bound(const K & key) const {
+        return map_.lower_bound(key);
+    }
+    
     // Same as std::map::size
     size_type size() const noexcept {
         return map_.size();
@@ -161,9 +213,38 @@ public:
         return map_.cend();
     }
     
+// ==== observers ====
+    
+    // Observers of every var in the map
+    std::vector<shared::observer_t<Key>> & observers() noexcept {
+        return observers_;
+    }
+    
+    const std::vector<shared::observer_t<Key>> & observers() const noexcept {
+        return observers_;
+    }
+    
+#ifdef SHARED_VAR_INSTRUMENTATION
+    // Called by the lookups, see shared::instrumentation::key_profiler_t
+    shared::instrumentation::lookup_hook_t<Key> & lookup_hook() noexcept {
+        return lookup_hook_;
+    }
+    
+    const shared::instrumentation::lookup_hook_t<Key> & lookup_hook() const noexcept {
+        return lookup_hook_;
+    }
+#endif
+    
 private:
     // The real map
     storage_type map_;
+    
+    // Map-wide observers, fired after the per-var observers
+    std::vector<shared::observer_t<Key>> observers_;
+    
+#ifdef SHARED_VAR_INSTRUMENTATION
+    shared::instrumentation::lookup_hook_t<Key> lookup_hook_;
+#endif
 };
 
 // The shared-variables container
@@ -200,6 +200,35 @@ public:
         key_ = Key();
     }
     
+    // The var name
+    constexpr const Key & key() const {
+        return key_;
+    }
+    
+    // The map containing the var
+    constexpr Map * map() const {
+        return map_;
+    }
+    
+// ==== observers ====
+    
+    // Tells the var observers the value has changed
+    void notify() {
+        if(map_ != nullptr) {
+            shared::notify(*map_, key_);
+        }
+    }
+    
+    // Assigns the value, then tells the var observers.
+    // Plain assignments don't notify, coroutines waiting with
+    // shared::coro::changed or shared::coro::until are resumed by this one.
+    template <shared::assignable_to<T> Value>
+    shared::var_view_t<T, Map> & set_and_notify(Value && value) {
+        *this = std::forward<Value>(value);
+        this->notify();
+        return *this;
+    }
+    
 private:
 // ==== internal vars ====
     
@@ -394,6 +423,35 @@ public:
         key_ = Key();
     }
     
+    // The var name
+    constexpr const Key & key() const {
+        return key_;
+    }
+    
+    // The map containing the var
+    constexpr Map * map() const {
+        return map_;
+    }
+    
+// ==== observers ====
+    
+    // Tells the var observers the value has changed
+    void notify() {
+        if(map_ != nullptr) {
+            shared::notify(*map_, key_);
+        }
+    }
+    
+    // Assigns the value, then tells the var observers.
+    // Plain assignments don't notify, coroutines waiting with
+    // shared::coro::changed or shared::coro::until are resumed by this one.
+    template <shared::assignable_to<T> Value>
+    shared::obj_view_t<T, Map> & set_and_notify(Value && value) {
+        *this = std::forward<Value>(value);
+        this->notify();
+        return *this;
+    }
+    
 private:
 // ==== internal vars ====
     
@@ -0,0 +1,123 @@
+#include "../shared_var/shared_var.hpp"
+#include "../shared_var/aggregates.hpp"
+#include "../shared_var/multithread.hpp"
+
+#include <iostream>
+#include <thread>
+
+using map_t = shared::map_type<std::string>;
+
+void change(map_t & map, const std::string & key, int value) {
+    shared::set<int>(map, key, value);
+    shared::notify(map, key);
+}
+
+int main() {
+    map_t map;
+    
+    shared::create<int>(map, "rack/a", 4);
+    shared::create<int>(map, "rack/b", 9);
+    shared::create<int>(map, "rack/c", 1);
+    shared::create<int>(map, "other", 100);
+    shared::create<double>(map, "rack/d", 0.5);
+    
+    // Existing vars are picked by the constructor, other types are ignored
+    auto rack = shared::aggregate::make_prefix_aggregate<int>(map, "rack/");
+    if(rack.count() != 3 || rack.sum() != 14) return 1;
+    if(rack.min() != 1 || rack.max() != 9) return 2;
+    if(rack.contains("other") || rack.contains("rack/d")) return 3;
+    
+    auto keys = shared::aggregate::make_keys_aggregate<int>(map, {"rack/a", "other", "missing"});
+    if(keys.count() != 2 || keys.sum() != 104) return 4;
+    if(keys.min() != 4 || keys.max() != 100) return 5;
+    
+    // The extremes got worse, found again by the next query
+    change(map, "rack/b", 2);
+    change(map, "rack/c", 3);
+    if(rack.sum() != 9 || rack.min() != 2 || rack.max() != 4) return 6;
+    
+    change(map, "other", 0);
+    if(keys.sum() != 4 || keys.min() != 0 || keys.max() != 4) return 7;
+    
+    // Vars created later join on their first notify
+    shared::create<int>(map, "rack/e", 50);
+    if(rack.contains("rack/e")) return 8;
+    shared::notify(map, "rack/e");
+    if(rack.count() != 4 || rack.sum() != 59 || rack.max() != 50) return 9;
+    
+    // Removed vars leave the aggregate
+    shared::remove(map, "rack/e");
+    if(rack.count() != 3 || rack.sum() != 9 || rack.max() != 4) return 10;
+    
+    shared::remove(map, "rack/b");
+    if(rack.count() != 2 || rack.min() != 3) return 11;
+    
+    shared::remove(map, "other");
+    if(keys.count() != 1 || keys.sum() != 4 || keys.max() != 4) return 12;
+    
+    // Vars created without notify are picked by recompute
+    shared::create<int>(map, "rack/f", -7);
+    rack.recompute();
+    if(rack.count() != 3 || rack.sum() != 0 || rack.min() != -7) return 13;
+    
+    // Floating point sums don't keep the rounding errors
+    shared::create<double>(map, "f/x", 0.1);
+    shared::create<double>(map, "f/y", 0.3);
+    auto doubles = shared::aggregate::make_prefix_aggregate<double>(map, "f/");
+    
+    // 0.1 + 1e16 - 1e16 lost the 0.1
+    shared::set<double>(map, "f/y", 1e16);
+    shared::notify(map, "f/y");
+    
+    for(int i = 0; i < 2; i++) {
+        shared::set<double>(map, "f/y", 0.3);
+        shared::notify(map, "f/y");
+    }
+    
+    if(doubles.sum() != 0.1 + 0.3) return 14;
+    
+    // Thread safe maps
+    shared::thread_safe::ts_var_map_t<std::string> ts_map;
+    shared::thread_safe::create<int>(ts_map, "x/1", 3);
+    shared::thread_safe::create<int>(ts_map, "x/2", 5);
+    
+    {
+        auto ts_aggregate = shared::aggregate::make_prefix_aggregate<int>(ts_map, "x/");
+        if(ts_aggregate.sum() != 8) return 15;
+        
+        shared::thread_safe::set<int>(ts_map, "x/1", 10);
+        shared::thread_safe::notify(ts_map, "x/1");
+        if(ts_aggregate.sum() != 15 || ts_aggregate.max() != 10) return 16;
+        
+        ts_aggregate.recompute();
+        if(ts_aggregate.sum() != 15) return 17;
+        
+        // Queried while another thread notifies, every change makes max() recompute
+        std::thread writer([&ts_map]() {
+            shared::thread_safe::ts_var_view_t<int, shared::thread_safe::ts_var_map_t<std::string>> x1(ts_map, "x/1");
+            
+            for(int value = 1000; value > 10; value--) {
+                x1.set_and_notify(value);
+            }
+        });
+        
+        for(int i = 0; i < 1000; i++) {
+            const int max = ts_aggregate.max();
+            if(max < 10 || max > 1000 || ts_aggregate.count() != 2 || !ts_aggregate.contains("x/2")) {
+                writer.join();
+                return 18;
+            }
+            (void) ts_aggregate.min();
+            (void) ts_aggregate.sum();
+        }
+        writer.join();
+        
+        if(ts_aggregate.sum() != 16 || ts_aggregate.max() != 11 || ts_aggregate.min() != 5) return 19;
+    }
+    
+    // Unregistered by the destructor
+    if(!ts_map.observers().empty()) return 20;
+    
+    std::cout << "aggregates OK\n";
+    return 0;
+}
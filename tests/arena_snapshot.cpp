@@ -0,0 +1,126 @@
+#include "../shared_var/shared_var.hpp"
+#include "../shared_var/arena_snapshot.hpp"
+#include "../shared_var/debug_tools.hpp"
+
+#include <iostream>
+
+// Trivially copyable, over-aligned
+struct alignas(32) vector_t {
+    double x = 0;
+    double y = 0;
+    double z = 0;
+    
+    std::string to_string() const {
+        return std::to_string(x) + ";" + std::to_string(y) + ";" + std::to_string(z);
+    }
+};
+
+template <typename Map>
+void populate(Map & map) {
+    for(int i = 0; i < 300; i++) {
+        const std::string key = "V" + std::to_string(i);
+        
+        switch(i % 4) {
+            case 0: shared::create<int>(map, key, i); break;
+            case 1: shared::create<char>(map, key, char('a' + i % 26)); break;
+            case 2: shared::create<vector_t>(map, key, vector_t{double(i), 1, 2}); break;
+            case 3: shared::create<std::string>(map, key, "text " + std::to_string(i)); break;
+        }
+    }
+    
+    for(int i = 0; i + 100 < 300; i += 8) {
+        shared::bind(map, "V" + std::to_string(i), "V" + std::to_string(i + 100));
+    }
+}
+
+template <typename Map>
+void mutate(Map & map) {
+    for(int i = 0; i < 300; i += 3) {
+        const std::string key = "V" + std::to_string(i);
+        
+        switch(i % 4) {
+            case 0: shared::set<int>(map, key, -i); break;
+            case 1: shared::set<char>(map, key, '?'); break;
+            case 2: shared::set<vector_t>(map, key, vector_t{-1, -1, -1}); break;
+            case 3: shared::set<std::string>(map, key, "changed"); break;
+        }
+    }
+    
+    for(int i = 1; i < 300; i += 7) {
+        shared::remove(map, "V" + std::to_string(i));
+    }
+    
+    for(int i = 2; i < 300; i += 11) {
+        shared::create<double>(map, "V" + std::to_string(i), 0.5, true);
+    }
+    
+    shared::create<int>(map, "new", 7);
+}
+
+int main() {
+    shared::map_type<std::string> serial_map;
+    shared::map_type<std::string> arena_map;
+    
+    populate(serial_map);
+    populate(arena_map);
+    
+    auto serial_data = shared::snapshot(serial_map);
+    const auto arena_data = shared::arena::snapshot(arena_map);
+    
+    if(arena_data.size() != serial_data.size()) return 1;
+    
+    // Only the strings have their own copy
+    std::size_t trivial_bytes = 0;
+    
+    for(const auto & entry : arena_data.entries) {
+        const bool is_string = *entry.type_id == typeid(std::string);
+        if(is_string != (entry.value != nullptr)) return 2;
+        
+        if(!is_string) {
+            if(entry.offset % entry.layout->alignment != 0) return 3;
+            if(entry.offset + entry.layout->size > arena_data.arena.size()) return 4;
+            trivial_bytes += entry.layout->size;
+        }
+    }
+    
+    if(arena_data.arena.size() < trivial_bytes) return 5;
+    
+    // Views of vars kept by the restore still see the values
+    auto view = shared::make_var<vector_t>(arena_map, "V6");
+    
+    mutate(serial_map);
+    mutate(arena_map);
+    
+    // Same map as shared::restore
+    shared::restore(serial_map, serial_data);
+    shared::arena::restore(arena_map, arena_data);
+    
+    const std::string restored = shared::debug::dump(serial_map, shared::debug::DUMP_CSV);
+    if(shared::debug::dump(arena_map, shared::debug::DUMP_CSV) != restored) return 6;
+    if(view.ref().x != 6) return 7;
+    
+    // The groups still share memory
+    shared::set<int>(arena_map, "V16", 5);
+    if(shared::get<int>(arena_map, "V116") != 5) return 8;
+    
+    // The snapshot can be restored again
+    mutate(arena_map);
+    shared::arena::restore(arena_map, arena_data);
+    
+    mutate(serial_map);
+    shared::restore(serial_map, serial_data);
+    if(shared::get<vector_t>(serial_map, "V6").x != 6) return 9;
+    
+    const std::string again = shared::debug::dump(arena_map, shared::debug::DUMP_CSV);
+    if(again != shared::debug::dump(serial_map, shared::debug::DUMP_CSV)) return 10;
+    
+    // Empty maps
+    shared::map_type<std::string> empty_map;
+    const auto empty_data = shared::arena::snapshot(empty_map);
+    if(!empty_data.empty() || !empty_data.arena.empty()) return 11;
+    shared::arena::restore(empty_map, empty_data);
+    if(!empty_map.empty()) return 12;
+    
+    std::cout << "arena snapshot OK\n";
+    return 0;
+}
@@ -0,0 +1,113 @@
+#include "../shared_var/shared_var.hpp"
+#include "../shared_var/arena_snapshot.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+// shared::snapshot / shared::restore against shared::arena::snapshot /
+// shared::arena::restore. The trivially copyable values are memcpy-ed
+// to and from a single buffer, std::string uses the copier in both.
+
+using map_t = shared::var_map_t<std::uint64_t>;
+
+// Trivially copyable, a cache line
+struct block_t {
+  std::uint64_t data[8];
+};
+
+template <typename T>
+static T make_value(std::uint64_t key) {
+  if constexpr (std::is_same_v<T, std::string>) {
+    return "value " + std::to_string(key);
+  } else if constexpr (std::is_same_v<T, block_t>) {
+    return block_t{{key, key, key, key, key, key, key, key}};
+  } else {
+    return T(key);
+  }
+}
+
+template <typename T>
+static std::unique_ptr<map_t> make_map(std::size_t vars) {
+  auto mp = std::make_unique<map_t>();
+  for (std::uint64_t key = 0; key < vars; key++) {
+    shared::create<T>(*mp, key, make_value<T>(key));
+  }
+  return mp;
+}
+
+static void size_args(benchmark::internal::Benchmark* b) {
+  b->RangeMultiplier(16)->Range(1 << 10, 1 << 20);
+  b->Unit(benchmark::kMicrosecond);
+}
+
+template <typename T>
+static void snapshot(benchmark::State& state) {
+  auto mp = make_map<T>(std::size_t(state.range(0)));
+
+  for (auto _ : state) {
+    auto data = shared::snapshot(*mp);
+    benchmark::DoNotOptimize(data.data());
+  }
+
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK_TEMPLATE(snapshot, std::uint64_t)->Apply(size_args);
+BENCHMARK_TEMPLATE(snapshot, block_t)->Apply(size_args);
+BENCHMARK_TEMPLATE(snapshot, std::string)->Apply(size_args);
+
+template <typename T>
+static void arena_snapshot(benchmark::State& state) {
+  auto mp = make_map<T>(std::size_t(state.range(0)));
+
+  for (auto _ : state) {
+    auto data = shared::arena::snapshot(*mp);
+    benchmark::DoNotOptimize(data.arena.data());
+  }
+
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK_TEMPLATE(arena_snapshot, std::uint64_t)->Apply(size_args);
+BENCHMARK_TEMPLATE(arena_snapshot, block_t)->Apply(size_args);
+BENCHMARK_TEMPLATE(arena_snapshot, std::string)->Apply(size_args);
+
+template <typename T>
+static void restore(benchmark::State& state) {
+  auto mp = make_map<T>(std::size_t(state.range(0)));
+  const auto data = shared::snapshot(*mp);
+
+  for (auto _ : state) {
+    // restore takes the data by value
+    state.PauseTiming();
+    auto copy = data;
+    state.ResumeTiming();
+
+    shared::restore(*mp, std::move(copy));
+    benchmark::ClobberMemory();
+  }
+
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK_TEMPLATE(restore, std::uint64_t)->Apply(size_args);
+BENCHMARK_TEMPLATE(restore, block_t)->Apply(size_args);
+BENCHMARK_TEMPLATE(restore, std::string)->Apply(size_args);
+
+template <typename T>
+static void arena_restore(benchmark::State& state) {
+  auto mp = make_map<T>(std::size_t(state.range(0)));
+  const auto data = shared::arena::snapshot(*mp);
+
+  for (auto _ : state) {
+    shared::arena::restore(*mp, data);
+    benchmark::ClobberMemory();
+  }
+
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK_TEMPLATE(arena_restore, std::uint64_t)->Apply(size_args);
+BENCHMARK_TEMPLATE(arena_restore, block_t)->Apply(size_args);
+BENCHMARK_TEMPLATE(arena_restore, std::string)->Apply(size_args);
+
+BENCHMARK_MAIN();
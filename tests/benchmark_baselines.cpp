@@ -0,0 +1,268 @@
+#include "../shared_var/shared_var.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <any>
+#include <bit>
+#include <functional>
+#include <map>
+#include <memory>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <variant>
+#include <vector>
+
+// The same workloads (insert, lookup, iterate, update) on the std containers,
+// on a flat hash map of type erased values and on shared::var_map_t,
+// to track the cost of the type erased shared::info_t.
+
+// Open addressing with linear probing, the layout of the common flat hash maps
+template <typename Value>
+class flat_map_t {
+public:
+  void reserve(std::size_t n) {
+    if (n * 8 > slots_.size() * 7) rehash(std::bit_ceil(n * 8 / 7 + 1));
+  }
+
+  void insert(const std::string & key, Value value) {
+    reserve(size_ + 1);
+    slot_t & slot = slots_[probe(key)];
+    if (!slot.is_used) size_++;
+    slot.key = key;
+    slot.value = std::move(value);
+    slot.is_used = true;
+  }
+
+  Value * find(const std::string & key) {
+    if (slots_.empty()) return nullptr;
+    slot_t & slot = slots_[probe(key)];
+    return slot.is_used ? &slot.value : nullptr;
+  }
+
+  template <typename Function>
+  void for_each(Function && function) {
+    for (slot_t & slot : slots_) {
+      if (slot.is_used) function(slot.value);
+    }
+  }
+
+private:
+  struct slot_t {
+    std::string key;
+    Value value;
+    bool is_used = false;
+  };
+
+  std::vector<slot_t> slots_;
+  std::size_t size_ = 0;
+
+  // The slot with the key, or the empty slot where it goes
+  std::size_t probe(const std::string & key) const {
+    const std::size_t mask = slots_.size() - 1;
+    std::size_t i = std::hash<std::string>()(key) & mask;
+    while (slots_[i].is_used && slots_[i].key != key) {
+      i = (i + 1) & mask;
+    }
+    return i;
+  }
+
+  void rehash(std::size_t capacity) {
+    std::vector<slot_t> old = std::move(slots_);
+    slots_ = std::vector<slot_t>(std::max<std::size_t>(capacity, 16));
+    for (slot_t & slot : old) {
+      if (slot.is_used) slots_[probe(slot.key)] = std::move(slot);
+    }
+  }
+};
+
+using variant_t = std::variant<int, double, std::string>;
+
+// ===== adapters =====
+
+// Every container stores int values, read and written through an int *
+
+struct std_map_t {
+  std::map<std::string, int> map;
+  void insert(const std::string & key, int value) { map.emplace(key, value); }
+  int * find(const std::string & key) { auto it = map.find(key); return it != map.end() ? &it->second : nullptr; }
+  long sum() { long s = 0; for (auto & [key, value] : map) s += value; return s; }
+};
+
+struct std_unordered_map_t {
+  std::unordered_map<std::string, int> map;
+  void insert(const std::string & key, int value) { map.emplace(key, value); }
+  int * find(const std::string & key) { auto it = map.find(key); return it != map.end() ? &it->second : nullptr; }
+  long sum() { long s = 0; for (auto & [key, value] : map) s += value; return s; }
+};
+
+struct flat_any_map_t {
+  flat_map_t<std::any> map;
+  void insert(const std::string & key, int value) { map.insert(key, value); }
+  int * find(const std::string & key) { std::any * value = map.find(key); return value != nullptr ? std::any_cast<int>(value) : nullptr; }
+  long sum() { long s = 0; map.for_each([&](std::any & value) { s += *std::any_cast<int>(&value); }); return s; }
+};
+
+struct flat_variant_map_t {
+  flat_map_t<variant_t> map;
+  void insert(const std::string & key, int value) { map.insert(key, value); }
+  int * find(const std::string & key) { variant_t * value = map.find(key); return value != nullptr ? std::get_if<int>(value) : nullptr; }
+  long sum() { long s = 0; map.for_each([&](variant_t & value) { s += *std::get_if<int>(&value); }); return s; }
+};
+
+// Checks the type like std::any_cast and std::get_if above (shared::get_ptr doesn't)
+struct var_map_adapter_t {
+  shared::map_type<std::string> map;
+  void insert(const std::string & key, int value) { shared::create<int>(map, key, value); }
+  int * find(const std::string & key) {
+    auto it = map.find(key);
+    return it != map.end() && shared::impl::are_types_equal<int>(it->second) ? shared::impl::info_to_data_ptr<int>(it->second) : nullptr;
+  }
+  long sum() { long s = 0; for (auto & [key, info] : map) s += *shared::impl::info_to_data_ptr<int>(info); return s; }
+};
+
+static const std::vector<std::string> & keys(std::size_t n) {
+  static std::vector<std::string> names;
+  while (names.size() < n) {
+    names.push_back("var" + std::to_string(names.size()));
+  }
+  return names;
+}
+
+// The keys of the lookups, in random order
+static std::vector<std::size_t> lookup_order(std::size_t n) {
+  std::vector<std::size_t> order(n);
+  for (std::size_t i = 0; i < n; i++) order[i] = i;
+  std::shuffle(order.begin(), order.end(), std::mt19937_64(42));
+  return order;
+}
+
+template <typename Container>
+static void fill(Container & container, std::size_t n) {
+  const auto & names = keys(n);
+  for (std::size_t i = 0; i < n; i++) {
+    container.insert(names[i], int(i));
+  }
+}
+
+// ===== workloads =====
+
+template <typename Container>
+static void insert(benchmark::State& state) {
+  const std::size_t n = std::size_t(state.range(0));
+  keys(n);
+
+  std::unique_ptr<Container> container;
+
+  // Code inside this loop is measured repeatedly
+  for (auto _ : state) {
+    // The previous container is destroyed outside the timing
+    state.PauseTiming();
+    container = std::make_unique<Container>();
+    state.ResumeTiming();
+
+    fill(*container, n);
+    benchmark::DoNotOptimize(container.get());
+  }
+
+  state.SetItemsProcessed(state.iterations() * std::int64_t(n));
+}
+
+template <typename Container>
+static void lookup(benchmark::State& state) {
+  const std::size_t n = std::size_t(state.range(0));
+  const auto & names = keys(n);
+  const auto order = lookup_order(n);
+
+  Container container;
+  fill(container, n);
+
+  // Code inside this loop is measured repeatedly
+  for (auto _ : state) {
+    for (std::size_t i : order) {
+      benchmark::DoNotOptimize(container.find(names[i]));
+    }
+  }
+
+  state.SetItemsProcessed(state.iterations() * std::int64_t(n));
+}
+
+template <typename Container>
+static void iterate(benchmark::State& state) {
+  const std::size_t n = std::size_t(state.range(0));
+
+  Container container;
+  fill(container, n);
+
+  // Code inside this loop is measured repeatedly
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(container.sum());
+  }
+
+  state.SetItemsProcessed(state.iterations() * std::int64_t(n));
+}
+
+// Find by key, then write
+template <typename Container>
+static void update(benchmark::State& state) {
+  const std::size_t n = std::size_t(state.range(0));
+  const auto & names = keys(n);
+  const auto order = lookup_order(n);
+
+  Container container;
+  fill(container, n);
+
+  // Code inside this loop is measured repeatedly
+  for (auto _ : state) {
+    for (std::size_t i : order) {
+      *container.find(names[i]) += 1;
+    }
+    benchmark::ClobberMemory();
+  }
+
+  state.SetItemsProcessed(state.iterations() * std::int64_t(n));
+}
+
+// The shared var way: views keep the pointer, no lookup per write
+static void update_var_view(benchmark::State& state) {
+  const std::size_t n = std::size_t(state.range(0));
+  const auto & names = keys(n);
+  const auto order = lookup_order(n);
+
+  var_map_adapter_t container;
+  fill(container, n);
+
+  std::vector<shared::var_view_t<int, shared::map_type<std::string>>> views;
+  views.reserve(n);
+  for (std::size_t i : order) {
+    views.emplace_back(container.map, names[i]);
+  }
+
+  // Code inside this loop is measured repeatedly
+  for (auto _ : state) {
+    for (auto & view : views) {
+      view = view + 1;
+    }
+    benchmark::ClobberMemory();
+  }
+
+  state.SetItemsProcessed(state.iterations() * std::int64_t(n));
+}
+
+// Register the functions as benchmarks
+#define SHARED_VAR_BASELINES(workload) \
+  BENCHMARK(workload<std_map_t>)->Name(#workload "/std::map")->RangeMultiplier(10)->Range(1000, 1000000); \
+  BENCHMARK(workload<std_unordered_map_t>)->Name(#workload "/std::unordered_map")->RangeMultiplier(10)->Range(1000, 1000000); \
+  BENCHMARK(workload<flat_any_map_t>)->Name(#workload "/flat_map<std::any>")->RangeMultiplier(10)->Range(1000, 1000000); \
+  BENCHMARK(workload<flat_variant_map_t>)->Name(#workload "/flat_map<std::variant>")->RangeMultiplier(10)->Range(1000, 1000000); \
+  BENCHMARK(workload<var_map_adapter_t>)->Name(#workload "/shared::var_map_t")->RangeMultiplier(10)->Range(1000, 1000000)
+
+SHARED_VAR_BASELINES(insert);
+SHARED_VAR_BASELINES(lookup);
+SHARED_VAR_BASELINES(iterate);
+SHARED_VAR_BASELINES(update);
+BENCHMARK(update_var_view)->Name("update/shared::var_view_t")->RangeMultiplier(10)->Range(1000, 1000000);
+
+// Run the benchmark
+BENCHMARK_MAIN();
@@ -0,0 +1,279 @@
+#include "../shared_var/shared_var.hpp"
+#include "../shared_var/shared_builder.hpp"
+#include "../shared_var/segmented_container.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <functional>
+#include <string>
+
+struct vehicle_t {
+  virtual ~vehicle_t() = default;
+  virtual int wheels() const = 0;
+};
+
+struct car_t : public vehicle_t {
+  int wheels() const override { return 4; }
+};
+
+struct bus_t : public vehicle_t {
+  int wheels() const override { return 6; }
+};
+
+struct truck_t : public vehicle_t {
+  int axles;
+  explicit truck_t(int axles_) : axles(axles_) {}
+  int wheels() const override { return 4 * axles; }
+};
+
+// The configuration captured by the builders
+struct truck_config_t {
+  int extra_axles = 2;
+  int max_axles = 8;
+};
+
+// A map with many builders, so the key lookup is not trivial
+static void make_builders(shared::map_type<std::string> & map) {
+  for (int i = 0; i < 1000; i++) {
+    shared::make_builder<vehicle_t, car_t>(map, "car" + std::to_string(i));
+  }
+  shared::make_builder<vehicle_t, bus_t>(map, "bus");
+}
+
+static void build_by_key(benchmark::State& state) {
+  shared::map_type<std::string> map;
+  make_builders(map);
+
+  const std::string key = "bus";
+
+  // Code inside this loop is measured repeatedly
+  for (auto _ : state) {
+    vehicle_t * vehicle = shared::build<vehicle_t>(map, key);
+    benchmark::DoNotOptimize(vehicle);
+    delete vehicle;
+  }
+}
+// Register the function as a benchmark
+BENCHMARK(build_by_key);
+
+static void build_by_id(benchmark::State& state) {
+  shared::map_type<std::string> map;
+  make_builders(map);
+
+  shared::builder::registry_t<vehicle_t> registry;
+  const shared::builder::builder_id_t id = registry.resolve(map, "bus");
+
+  // Code inside this loop is measured repeatedly
+  for (auto _ : state) {
+    vehicle_t * vehicle = registry.build(id);
+    benchmark::DoNotOptimize(vehicle);
+    delete vehicle;
+  }
+}
+// Register the function as a benchmark
+BENCHMARK(build_by_id);
+
+static void build_with_std_function(benchmark::State& state) {
+  shared::map_type<std::string> map;
+  make_builders(map);
+
+  const truck_config_t config;
+  shared::make_var<std::function<vehicle_t *(int)>>(map, "truck", [config](int axles) -> vehicle_t * {
+    return new truck_t(std::min(axles + config.extra_axles, config.max_axles));
+  });
+
+  const std::string key = "truck";
+
+  // Code inside this loop is measured repeatedly
+  for (auto _ : state) {
+    auto & builder = shared::auto_get<std::function<vehicle_t *(int)>>(map, key);
+    vehicle_t * vehicle = builder(3);
+    benchmark::DoNotOptimize(vehicle);
+    delete vehicle;
+  }
+}
+// Register the function as a benchmark
+BENCHMARK(build_with_std_function);
+
+static void build_with_arg_builder(benchmark::State& state) {
+  shared::map_type<std::string> map;
+  make_builders(map);
+
+  const truck_config_t config;
+  shared::make_arg_builder_from<vehicle_t, int>(map, "truck", [config](int axles) -> vehicle_t * {
+    return new truck_t(std::min(axles + config.extra_axles, config.max_axles));
+  });
+
+  const std::string key = "truck";
+
+  // Code inside this loop is measured repeatedly
+  for (auto _ : state) {
+    vehicle_t * vehicle = shared::build_with<vehicle_t, int>(map, key, 3);
+    benchmark::DoNotOptimize(vehicle);
+    delete vehicle;
+  }
+}
+// Register the function as a benchmark
+BENCHMARK(build_with_arg_builder);
+
+static void copy_std_function(benchmark::State& state) {
+  const truck_config_t config;
+  const std::string name = "truck";
+  std::function<vehicle_t *(int)> builder = [config, name](int axles) -> vehicle_t * {
+    return new truck_t(std::min(axles + config.extra_axles, config.max_axles + int(name.size())));
+  };
+
+  // Snapshots copy every builder
+  for (auto _ : state) {
+    std::function<vehicle_t *(int)> copy = builder;
+    benchmark::DoNotOptimize(copy);
+  }
+}
+// Register the function as a benchmark
+BENCHMARK(copy_std_function);
+
+static void copy_arg_builder(benchmark::State& state) {
+  const truck_config_t config;
+  const char * name = "truck";
+  shared::arg_builder_type<vehicle_t, int> builder([config, name](int axles) -> vehicle_t * {
+    return new truck_t(std::min(axles + config.extra_axles, config.max_axles + int(std::strlen(name))));
+  });
+
+  // Snapshots copy every builder
+  for (auto _ : state) {
+    shared::arg_builder_type<vehicle_t, int> copy = builder;
+    benchmark::DoNotOptimize(copy);
+  }
+}
+// Register the function as a benchmark
+BENCHMARK(copy_arg_builder);
+
+static void build_many_separately(benchmark::State& state) {
+  shared::map_type<std::string> map;
+  make_builders(map);
+
+  const std::size_t count = std::size_t(state.range(0));
+
+  // Code inside this loop is measured repeatedly
+  for (auto _ : state) {
+    std::vector<std::unique_ptr<vehicle_t>> vehicles;
+    vehicles.reserve(count);
+
+    for (std::size_t i = 0; i < count; i++) {
+      vehicles.push_back(shared::build_unique<vehicle_t>(map, "bus"));
+    }
+
+    int wheels = 0;
+    for (const auto & vehicle : vehicles) {
+      wheels += vehicle->wheels();
+    }
+    benchmark::DoNotOptimize(wheels);
+  }
+}
+// Register the function as a benchmark
+BENCHMARK(build_many_separately)->Arg(100000);
+
+static void build_many_contiguous(benchmark::State& state) {
+  shared::map_type<std::string> map;
+  make_builders(map);
+
+  const std::size_t count = std::size_t(state.range(0));
+
+  // Code inside this loop is measured repeatedly
+  for (auto _ : state) {
+    auto vehicles = shared::build_n<vehicle_t>(map, "bus", count);
+
+    int wheels = 0;
+    for (vehicle_t * vehicle : vehicles) {
+      wheels += vehicle->wheels();
+    }
+    benchmark::DoNotOptimize(wheels);
+  }
+}
+// Register the function as a benchmark
+BENCHMARK(build_many_contiguous)->Arg(100000);
+
+static void churn_unique(benchmark::State& state) {
+  shared::map_type<std::string> map;
+  make_builders(map);
+
+  // Code inside this loop is measured repeatedly
+  for (auto _ : state) {
+    // Every request builds and destroys a few objects
+    auto first = shared::build_unique<vehicle_t>(map, "bus");
+    auto second = shared::build_unique<vehicle_t>(map, "car0");
+    benchmark::DoNotOptimize(first->wheels() + second->wheels());
+  }
+}
+// Register the function as a benchmark
+BENCHMARK(churn_unique);
+
+static void churn_pooled(benchmark::State& state) {
+  shared::map_type<std::string> map;
+  make_builders(map);
+
+  // Code inside this loop is measured repeatedly
+  for (auto _ : state) {
+    // Every request builds and destroys a few objects
+    auto first = shared::build_pooled<vehicle_t>(map, "bus");
+    auto second = shared::build_pooled<vehicle_t>(map, "car0");
+    benchmark::DoNotOptimize(first->wheels() + second->wheels());
+  }
+}
+// Register the function as a benchmark
+BENCHMARK(churn_pooled);
+
+// Builds cars and buses, shuffled
+static std::vector<std::string> mixed_keys(std::size_t count) {
+  std::vector<std::string> keys;
+  std::srand(1);
+  for (std::size_t i = 0; i < count; i++) {
+    keys.push_back(rand() % 2 == 0 ? "bus" : "car0");
+  }
+  return keys;
+}
+
+static void iterate_unique_ptrs(benchmark::State& state) {
+  shared::map_type<std::string> map;
+  make_builders(map);
+
+  std::vector<std::unique_ptr<vehicle_t>> vehicles;
+  for (const std::string & key : mixed_keys(std::size_t(state.range(0)))) {
+    vehicles.push_back(shared::build_unique<vehicle_t>(map, key));
+  }
+
+  // Code inside this loop is measured repeatedly
+  for (auto _ : state) {
+    int wheels = 0;
+    for (const auto & vehicle : vehicles) {
+      wheels += vehicle->wheels();
+    }
+    benchmark::DoNotOptimize(wheels);
+  }
+}
+// Register the function as a benchmark
+BENCHMARK(iterate_unique_ptrs)->Arg(100000);
+
+static void iterate_segmented(benchmark::State& state) {
+  shared::map_type<std::string> map;
+  make_builders(map);
+
+  shared::builder::segmented_t<vehicle_t> vehicles;
+  for (const std::string & key : mixed_keys(std::size_t(state.range(0)))) {
+    vehicles.emplace(map, key);
+  }
+
+  // Code inside this loop is measured repeatedly
+  for (auto _ : state) {
+    int wheels = 0;
+    vehicles.for_each([&](vehicle_t & vehicle) {
+      wheels += vehicle.wheels();
+    });
+    benchmark::DoNotOptimize(wheels);
+  }
+}
+// Register the function as a benchmark
+BENCHMARK(iterate_segmented)->Arg(100000);
+
+// Run the benchmark
+BENCHMARK_MAIN();
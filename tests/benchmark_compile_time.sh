@@ -0,0 +1,104 @@
+#!/bin/bash
+# Build-time benchmark of shared_var/extern_templates.cpp
+#
+# Compiles the same translation units twice, header only and with
+# SHARED_VAR_EXTERN_TEMPLATES, then links each build.
+#
+# usage: tests/benchmark_compile_time.sh [units=16] [flags=-O0]
+# env:   CXX (default g++)
+
+set -e
+
+units=${1:-16}
+flags=${2:--O0}
+cxx=${CXX:-g++}
+
+root=$(cd "$(dirname "$0")/.." && pwd)
+work=$(mktemp -d)
+trap 'rm -rf "$work"' EXIT
+
+now_ms() {
+    echo $(( $(date +%s%N) / 1000000 ))
+}
+
+# Every unit uses the key-only machinery like a typical module would:
+# creates and binds a few vars, then snapshots and restores the map
+for (( i = 0; i < units; i++ )); do
+    cat > "$work/unit_$i.cpp" << EOF
+#include "$root/shared_var/shared_var.hpp"
+#include "$root/shared_var/multithread.hpp"
+
+struct value_$i { int data[$(( i % 4 + 1 ))]; };
+
+int unit_$i() {
+    shared::var_map_t<std::string> mp;
+    shared::thread_safe::ts_var_map_t<std::string> ts_mp;
+
+    shared::create<value_$i>(mp, "a");
+    shared::create<value_$i>(mp, "b");
+    shared::bind(mp, "a", "b");
+    shared::unbind(mp, "a", "b");
+    shared::isolate(mp, "a");
+
+    auto data = shared::snapshot(mp);
+    shared::remove(mp, "a");
+    shared::restore(mp, data);
+    shared::unbind_all(mp);
+
+    shared::thread_safe::create<value_$i>(ts_mp, "a");
+    shared::thread_safe::create<value_$i>(ts_mp, "b");
+    shared::thread_safe::bind(ts_mp, "a", "b");
+    shared::thread_safe::remove(ts_mp, "b");
+
+    int size = static_cast<int>(mp.size() + ts_mp.size());
+    shared::remove_all(mp);
+    return size;
+}
+EOF
+done
+
+{
+    for (( i = 0; i < units; i++ )); do echo "int unit_$i();"; done
+    echo "int main() {"
+    echo "    int sum = 0;"
+    for (( i = 0; i < units; i++ )); do echo "    sum += unit_$i();"; done
+    echo "    return sum == $(( units * 3 )) ? 0 : 1;"
+    echo "}"
+} > "$work/main.cpp"
+
+# Compiles every unit, prints the elapsed time in ms
+build() {
+    local out=$1
+    shift
+    local begin=$(now_ms)
+
+    mkdir -p "$work/$out"
+    for (( i = 0; i < units; i++ )); do
+        $cxx -std=c++20 $flags "$@" -c "$work/unit_$i.cpp" -o "$work/$out/unit_$i.o"
+    done
+    $cxx -std=c++20 $flags -c "$work/main.cpp" -o "$work/$out/main.o"
+
+    echo $(( $(now_ms) - begin ))
+}
+
+header_only_ms=$(build header_only)
+extern_ms=$(build extern -DSHARED_VAR_EXTERN_TEMPLATES)
+
+begin=$(now_ms)
+$cxx -std=c++20 $flags -c "$root/shared_var/extern_templates.cpp" -o "$work/extern/extern_templates.o"
+component_ms=$(( $(now_ms) - begin ))
+
+$cxx "$work"/header_only/*.o -o "$work/header_only.out" -lpthread
+$cxx "$work"/extern/*.o -o "$work/extern.out" -lpthread
+"$work/header_only.out"
+"$work/extern.out"
+
+header_only_bytes=$(cat "$work"/header_only/unit_*.o | wc -c)
+extern_bytes=$(cat "$work"/extern/unit_*.o | wc -c)
+
+echo "$units units, $cxx $flags"
+printf "%-14s %10s %14s\n" "build" "time [ms]" "objects [B]"
+printf "%-14s %10d %14d\n" "header only" "$header_only_ms" "$header_only_bytes"
+printf "%-14s %10d %14d\n" "extern" "$extern_ms" "$extern_bytes"
+printf "%-14s %10d %14s\n" "component" "$component_ms" "(once)"
+echo "per unit: $(( header_only_ms / units )) ms -> $(( extern_ms / units )) ms"
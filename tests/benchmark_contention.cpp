@@ -0,0 +1,244 @@
+#include "../shared_var/shared_var.hpp"
+#include "../shared_var/multithread.hpp"
+#include "../shared_var/atomic_wrapper.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+using map_t = shared::thread_safe::ts_var_map_t<std::string>;
+
+// Atomic values, so writes under the read lock don't race
+using value_t = shared::atomic::atomic_wrapper_t<std::int64_t>;
+
+static constexpr std::size_t key_count = 10000;
+static constexpr std::size_t hot_key_count = 8;
+
+enum access_t : int {
+  UNIFORM = 0, // any of the key_count keys
+  HOT     = 1  // 90% of the accesses go to hot_key_count keys
+};
+
+static std::unique_ptr<map_t> map;
+static std::vector<std::string> keys;
+
+static int max_threads() {
+  return int(std::max(4u, std::thread::hardware_concurrency()));
+}
+
+static void make_map(const benchmark::State&) {
+  map = std::make_unique<map_t>();
+  keys.clear();
+  for (std::size_t i = 0; i < key_count; i++) {
+    keys.push_back("k" + std::to_string(i));
+    shared::thread_safe::create<value_t>(*map, keys.back(), std::int64_t(i));
+  }
+}
+
+static void destroy_map(const benchmark::State&) {
+  map.reset();
+}
+
+// Per-thread random numbers, cheaper than the std engines
+struct xorshift_t {
+  std::uint64_t state;
+
+  explicit xorshift_t(int seed) : state(0x9E3779B97F4A7C15ull * std::uint64_t(seed + 1)) {}
+
+  std::uint64_t operator()() {
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+    return state;
+  }
+};
+
+static const std::string & pick_key(xorshift_t & rng, access_t access) {
+  const std::uint64_t r = rng();
+  if (access == HOT && r % 10 != 0) {
+    return keys[(r >> 8) % hot_key_count];
+  }
+  return keys[(r >> 8) % key_count];
+}
+
+// Times one in "sample_period" operations,
+// reports the percentiles of this thread (averaged over the threads)
+class latency_t {
+public:
+  static constexpr std::uint64_t sample_period = 8;
+
+  template <typename Operation>
+  void run(Operation && operation) {
+    if (++counter_ % sample_period != 0) {
+      operation();
+      return;
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    operation();
+    const auto end = std::chrono::steady_clock::now();
+    samples_.push_back(std::chrono::duration<double, std::nano>(end - start).count());
+  }
+
+  // "reporting_threads" of the state.threads() threads call report
+  void report(benchmark::State& state, int reporting_threads) {
+    if (samples_.empty()) return;
+    std::sort(samples_.begin(), samples_.end());
+
+    // The counters are averaged over every thread
+    const double scale = double(state.threads()) / double(reporting_threads);
+    const auto percentile = [this, scale](double p) {
+      return scale * samples_[std::min(samples_.size() - 1, std::size_t(p / 100.0 * double(samples_.size())))];
+    };
+
+    state.counters["p50_ns"] = benchmark::Counter(percentile(50.0), benchmark::Counter::kAvgThreads);
+    state.counters["p99_ns"] = benchmark::Counter(percentile(99.0), benchmark::Counter::kAvgThreads);
+    state.counters["p999_ns"] = benchmark::Counter(percentile(99.9), benchmark::Counter::kAvgThreads);
+  }
+
+private:
+  std::uint64_t counter_ = 0;
+  std::vector<double> samples_;
+};
+
+// ===== thread_safe::get and thread_safe::set =====
+
+// range(0): percentage of reads, range(1): access_t
+static void map_read_write(benchmark::State& state) {
+  const int read_percent = int(state.range(0));
+  const access_t access = access_t(state.range(1));
+
+  xorshift_t rng(state.thread_index());
+  latency_t latency;
+
+  // Code inside this loop is measured repeatedly
+  for (auto _ : state) {
+    const std::string & key = pick_key(rng, access);
+    const bool is_read = int(rng() % 100) < read_percent;
+
+    latency.run([&]() {
+      if (is_read) {
+        benchmark::DoNotOptimize(std::int64_t(shared::thread_safe::get<value_t>(*map, key)));
+      }
+      else {
+        shared::thread_safe::set<value_t>(*map, key, std::int64_t(rng()));
+      }
+    });
+  }
+
+  state.SetItemsProcessed(state.iterations());
+  latency.report(state, state.threads());
+}
+// Register the function as a benchmark
+BENCHMARK(map_read_write)
+  ->ArgNames({"read%", "hot"})
+  ->ArgsProduct({{100, 95, 50, 0}, {UNIFORM, HOT}})
+  ->Setup(make_map)->Teardown(destroy_map)
+  ->ThreadRange(1, max_threads())->UseRealTime();
+
+// ===== views =====
+
+// Every thread has its own view of the same var.
+// range(0): percentage of loads
+static void atomic_view_load_store(benchmark::State& state) {
+  const int load_percent = int(state.range(0));
+
+  shared::atomic::atomic_view_type<std::int64_t, map_t> view(*map, keys[0]);
+
+  xorshift_t rng(state.thread_index());
+  latency_t latency;
+
+  // Code inside this loop is measured repeatedly
+  for (auto _ : state) {
+    const bool is_load = int(rng() % 100) < load_percent;
+
+    latency.run([&]() {
+      if (is_load) {
+        benchmark::DoNotOptimize(std::int64_t(view.load()));
+      }
+      else {
+        view.store(std::int64_t(rng()));
+      }
+    });
+  }
+
+  state.SetItemsProcessed(state.iterations());
+  latency.report(state, state.threads());
+}
+// Register the function as a benchmark
+BENCHMARK(atomic_view_load_store)
+  ->ArgNames({"load%"})
+  ->Arg(100)->Arg(90)->Arg(50)
+  ->Setup(make_map)->Teardown(destroy_map)
+  ->ThreadRange(1, max_threads())->UseRealTime();
+
+// Plain ts_var_view_t reads, the baseline of the atomic views
+static void view_load(benchmark::State& state) {
+  shared::thread_safe::ts_var_view_t<value_t, map_t> view(*map, keys[0]);
+  latency_t latency;
+
+  // Code inside this loop is measured repeatedly
+  for (auto _ : state) {
+    latency.run([&]() {
+      benchmark::DoNotOptimize(std::int64_t(view.load()));
+    });
+  }
+
+  state.SetItemsProcessed(state.iterations());
+  latency.report(state, state.threads());
+}
+// Register the function as a benchmark
+BENCHMARK(view_load)
+  ->Setup(make_map)->Teardown(destroy_map)
+  ->ThreadRange(1, max_threads())->UseRealTime();
+
+// ===== reads during topology changes =====
+
+// Thread 0 binds and unbinds hot vars (write lock),
+// the other threads read the hot vars (read lock).
+// range(0): access_t of the readers
+static void read_during_rewiring(benchmark::State& state) {
+  const access_t access = access_t(state.range(0));
+  const bool is_writer = state.thread_index() == 0;
+
+  xorshift_t rng(state.thread_index());
+  latency_t latency;
+  std::size_t pair = 0;
+
+  // Code inside this loop is measured repeatedly
+  for (auto _ : state) {
+    if (is_writer) {
+      const std::string & lhs = keys[pair % hot_key_count];
+      const std::string & rhs = keys[(pair + 1) % hot_key_count];
+      shared::thread_safe::bind(*map, lhs, rhs);
+      shared::thread_safe::unbind(*map, lhs, rhs);
+      pair++;
+    }
+    else {
+      const std::string & key = pick_key(rng, access);
+      latency.run([&]() {
+        benchmark::DoNotOptimize(std::int64_t(shared::thread_safe::get<value_t>(*map, key)));
+      });
+    }
+  }
+
+  // Only the readers report latencies
+  if (!is_writer) {
+    latency.report(state, state.threads() - 1);
+  }
+}
+// Register the function as a benchmark
+BENCHMARK(read_during_rewiring)
+  ->ArgNames({"hot"})
+  ->Arg(UNIFORM)->Arg(HOT)
+  ->Setup(make_map)->Teardown(destroy_map)
+  ->ThreadRange(2, max_threads())->UseRealTime();
+
+// Run the benchmark
+BENCHMARK_MAIN();
@@ -0,0 +1,254 @@
+#include "../shared_var/shared_var.hpp"
+#include "../shared_var/memory_stats.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include "counting_allocator.hpp"
+
+#include <cstddef>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+
+// ===== budgets =====
+
+// Maximum allocations per operation and peak bytes per var of each benchmark,
+// with libstdc++ on 64 bit and short keys. Raise them only on purpose.
+struct budget_t {
+  const char * name;
+  double allocations_per_op;
+  double peak_bytes_per_var;
+};
+
+static constexpr budget_t budgets[] = {
+  {"create",    2.5, 400.0},
+  {"view",      1.0,  64.0},
+  {"bind",      2.5,  64.0},
+  {"snapshot",  1.5, 320.0},
+  {"restore",   2.5, 400.0},
+};
+
+static std::vector<std::string> budget_failures;
+
+// Reports the measurements and compares them to the budget.
+// "ops" operations over "vars" vars, over every iteration.
+static void report(benchmark::State& state, const char * name, double allocations, double ops, double peak_bytes, std::size_t vars) {
+  const double allocations_per_op = allocations / ops;
+  const double peak_bytes_per_var = peak_bytes / double(vars);
+
+  state.counters["allocs/op"] = allocations_per_op;
+  state.counters["peak_bytes/var"] = peak_bytes_per_var;
+
+  for (const budget_t & budget : budgets) {
+    if (std::string(budget.name) != name) continue;
+
+    if (allocations_per_op > budget.allocations_per_op || peak_bytes_per_var > budget.peak_bytes_per_var) {
+      std::string error = std::string(name) + "/" + std::to_string(vars) + " over budget: " +
+        std::to_string(allocations_per_op) + " allocs/op, " + std::to_string(peak_bytes_per_var) + " peak bytes/var";
+      budget_failures.push_back(error);
+      state.SkipWithError(error.c_str());
+    }
+  }
+}
+
+using map_t = shared::map_type<std::string>;
+
+static const std::vector<std::string> & keys(std::size_t n) {
+  static std::vector<std::string> names;
+  while (names.size() < n) {
+    names.push_back("v" + std::to_string(names.size()));
+  }
+  return names;
+}
+
+static void create_vars(map_t & map, std::size_t n) {
+  const auto & names = keys(n);
+  for (std::size_t i = 0; i < n; i++) {
+    shared::create<int>(map, names[i], int(i));
+  }
+}
+
+// ===== create =====
+
+static void create(benchmark::State& state) {
+  const std::size_t n = std::size_t(state.range(0));
+  keys(n);
+
+  std::unique_ptr<map_t> map;
+  double allocations = 0;
+  double peak_bytes = 0;
+  double retained_bytes = 0;
+  double estimated_bytes = 0;
+
+  // Code inside this loop is measured repeatedly
+  for (auto _ : state) {
+    // The previous map is destroyed outside the timing
+    state.PauseTiming();
+    map = std::make_unique<map_t>();
+    state.ResumeTiming();
+
+    allocation_scope_t scope;
+    create_vars(*map, n);
+
+    allocations += double(scope.allocations());
+    peak_bytes = std::max(peak_bytes, double(scope.peak_bytes()));
+    retained_bytes = scope.retained_bytes();
+
+    state.PauseTiming();
+    estimated_bytes = double(shared::memory::memory_stats(*map).total());
+    state.ResumeTiming();
+  }
+
+  // memory_stats estimates the same bytes without an allocator
+  state.counters["bytes/var"] = retained_bytes / double(n);
+  state.counters["estimated_bytes/var"] = estimated_bytes / double(n);
+  report(state, "create", allocations, double(state.iterations()) * double(n), peak_bytes, n);
+}
+// Register the function as a benchmark
+BENCHMARK(create)->RangeMultiplier(10)->Range(1000, 1000000)->Unit(benchmark::kMillisecond);
+
+// ===== view construction =====
+
+static void view(benchmark::State& state) {
+  const std::size_t n = std::size_t(state.range(0));
+  const auto & names = keys(n);
+
+  map_t map;
+  create_vars(map, n);
+
+  std::vector<shared::var_view_t<int, map_t>> views;
+  views.reserve(n);
+
+  double allocations = 0;
+  double peak_bytes = 0;
+
+  // Code inside this loop is measured repeatedly
+  for (auto _ : state) {
+    allocation_scope_t scope;
+    for (std::size_t i = 0; i < n; i++) {
+      views.emplace_back(map, names[i]);
+    }
+
+    allocations += double(scope.allocations());
+    peak_bytes = std::max(peak_bytes, double(scope.peak_bytes()));
+
+    state.PauseTiming();
+    views.clear();
+    state.ResumeTiming();
+  }
+
+  report(state, "view", allocations, double(state.iterations()) * double(n), peak_bytes, n);
+}
+// Register the function as a benchmark
+BENCHMARK(view)->RangeMultiplier(10)->Range(1000, 1000000)->Unit(benchmark::kMillisecond);
+
+// ===== bind =====
+
+// Binds the vars in pairs
+static void bind(benchmark::State& state) {
+  const std::size_t n = std::size_t(state.range(0));
+  const auto & names = keys(n);
+
+  std::unique_ptr<map_t> map;
+  double allocations = 0;
+  double peak_bytes = 0;
+
+  // Code inside this loop is measured repeatedly
+  for (auto _ : state) {
+    state.PauseTiming();
+    map = std::make_unique<map_t>();
+    create_vars(*map, n);
+    state.ResumeTiming();
+
+    allocation_scope_t scope;
+    for (std::size_t i = 0; i + 1 < n; i += 2) {
+      shared::bind(*map, names[i], names[i + 1]);
+    }
+
+    allocations += double(scope.allocations());
+    peak_bytes = std::max(peak_bytes, double(scope.peak_bytes()));
+  }
+
+  report(state, "bind", allocations, double(state.iterations()) * double(n / 2), peak_bytes, n);
+}
+// Register the function as a benchmark
+BENCHMARK(bind)->RangeMultiplier(10)->Range(1000, 1000000)->Unit(benchmark::kMillisecond);
+
+// ===== snapshot and restore =====
+
+static void snapshot(benchmark::State& state) {
+  const std::size_t n = std::size_t(state.range(0));
+
+  map_t map;
+  create_vars(map, n);
+
+  double allocations = 0;
+  double peak_bytes = 0;
+
+  // Code inside this loop is measured repeatedly
+  for (auto _ : state) {
+    allocation_scope_t scope;
+    auto data = shared::snapshot(map);
+    benchmark::DoNotOptimize(data.data());
+
+    allocations += double(scope.allocations());
+    peak_bytes = std::max(peak_bytes, double(scope.peak_bytes()));
+
+    // The snapshot is destroyed outside the timing
+    state.PauseTiming();
+    data.clear();
+    data.shrink_to_fit();
+    state.ResumeTiming();
+  }
+
+  report(state, "snapshot", allocations, double(state.iterations()) * double(n), peak_bytes, n);
+}
+// Register the function as a benchmark
+BENCHMARK(snapshot)->RangeMultiplier(10)->Range(1000, 1000000)->Unit(benchmark::kMillisecond);
+
+// Restores every var into an empty map
+static void restore(benchmark::State& state) {
+  const std::size_t n = std::size_t(state.range(0));
+
+  map_t source;
+  create_vars(source, n);
+  const auto data = shared::snapshot(source);
+
+  std::unique_ptr<map_t> map;
+  double allocations = 0;
+  double peak_bytes = 0;
+
+  // Code inside this loop is measured repeatedly
+  for (auto _ : state) {
+    state.PauseTiming();
+    map = std::make_unique<map_t>();
+    auto copy = data;
+    state.ResumeTiming();
+
+    allocation_scope_t scope;
+    shared::restore(*map, std::move(copy));
+
+    allocations += double(scope.allocations());
+    peak_bytes = std::max(peak_bytes, double(scope.peak_bytes()));
+  }
+
+  report(state, "restore", allocations, double(state.iterations()) * double(n), peak_bytes, n);
+}
+// Register the function as a benchmark
+BENCHMARK(restore)->RangeMultiplier(10)->Range(1000, 1000000)->Unit(benchmark::kMillisecond);
+
+// Runs the benchmarks, fails if any of them is over budget
+int main(int argc, char** argv) {
+  benchmark::Initialize(&argc, argv);
+  if (benchmark::ReportUnrecognizedArguments(argc, argv)) return 1;
+
+  benchmark::RunSpecifiedBenchmarks();
+  benchmark::Shutdown();
+
+  for (const std::string & failure : budget_failures) {
+    std::fprintf(stderr, "BUDGET EXCEEDED: %s\n", failure.c_str());
+  }
+
+  return budget_failures.empty() ? 0 : 1;
+}
@@ -0,0 +1,95 @@
+#include "../shared_var/shared_var.hpp"
+#include "../shared_var/parallel_snapshot.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Scaling of shared::parallel::snapshot and shared::parallel::restore
+// with the number of threads, "threads = 0" is the serial shared::snapshot
+// and shared::restore.
+// Args: {vars, threads}
+
+using map_t = shared::var_map_t<std::uint64_t>;
+
+static int max_threads() {
+  return int(std::max(8u, std::thread::hardware_concurrency()));
+}
+
+static void thread_args(benchmark::internal::Benchmark* b) {
+  for (std::int64_t vars : {1 << 16, 1 << 20, 1 << 21}) {
+    b->Args({vars, 0});
+    for (int threads = 1; threads <= max_threads(); threads *= 2) {
+      b->Args({vars, threads});
+    }
+  }
+  b->ArgNames({"vars", "threads"});
+  b->Unit(benchmark::kMillisecond);
+  b->UseRealTime();
+}
+
+// Ints and short strings, every 8th var bound to its neighbour
+template <typename T>
+static std::unique_ptr<map_t> make_map(std::size_t vars) {
+  auto mp = std::make_unique<map_t>();
+  for (std::uint64_t key = 0; key < vars; key++) {
+    if constexpr (std::is_same_v<T, std::string>) {
+      shared::create<T>(*mp, key, "value " + std::to_string(key));
+    } else {
+      shared::create<T>(*mp, key, T(key));
+    }
+  }
+  for (std::uint64_t key = 0; key + 1 < vars; key += 8) {
+    shared::bind(*mp, key, key + 1);
+  }
+  return mp;
+}
+
+template <typename T>
+static void snapshot(benchmark::State& state) {
+  const auto vars = std::size_t(state.range(0));
+  const auto threads = unsigned(state.range(1));
+  auto mp = make_map<T>(vars);
+
+  for (auto _ : state) {
+    auto data = threads == 0 ? shared::snapshot(*mp) : shared::parallel::snapshot(*mp, threads);
+    benchmark::DoNotOptimize(data.data());
+  }
+
+  state.SetItemsProcessed(state.iterations() * std::int64_t(vars));
+}
+BENCHMARK_TEMPLATE(snapshot, std::uint64_t)->Apply(thread_args);
+BENCHMARK_TEMPLATE(snapshot, std::string)->Apply(thread_args);
+
+template <typename T>
+static void restore(benchmark::State& state) {
+  const auto vars = std::size_t(state.range(0));
+  const auto threads = unsigned(state.range(1));
+  auto mp = make_map<T>(vars);
+  const auto data = shared::snapshot(*mp);
+
+  for (auto _ : state) {
+    // restore takes the data by value
+    state.PauseTiming();
+    auto copy = data;
+    state.ResumeTiming();
+
+    if (threads == 0) {
+      shared::restore(*mp, std::move(copy));
+    } else {
+      shared::parallel::restore(*mp, std::move(copy), threads);
+    }
+    benchmark::ClobberMemory();
+  }
+
+  state.SetItemsProcessed(state.iterations() * std::int64_t(vars));
+}
+BENCHMARK_TEMPLATE(restore, std::uint64_t)->Apply(thread_args);
+BENCHMARK_TEMPLATE(restore, std::string)->Apply(thread_args);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,188 @@
+#include "../shared_var/shared_var.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include "counting_allocator.hpp"
+
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+using map_t = shared::map_type<std::string>;
+
+// Keys shared by every benchmark, built once
+static const std::vector<std::string> & keys(std::size_t n) {
+  static std::vector<std::string> names;
+  while (names.size() < n) {
+    names.push_back("v" + std::to_string(names.size()));
+  }
+  return names;
+}
+
+static void create_vars(map_t & map, std::size_t n) {
+  const auto & names = keys(n);
+  for (std::size_t i = 0; i < n; i++) {
+    shared::create<int>(map, names[i], int(i));
+  }
+}
+
+// v0 - v1 - v2 - ... - vN-1
+static void make_chain(map_t & map, std::size_t n) {
+  create_vars(map, n);
+  const auto & names = keys(n);
+  for (std::size_t i = 0; i + 1 < n; i++) {
+    shared::bind(map, names[i], names[i + 1]);
+  }
+}
+
+// v0 connected to every other var
+static void make_star(map_t & map, std::size_t n) {
+  create_vars(map, n);
+  const auto & names = keys(n);
+  for (std::size_t i = 1; i < n; i++) {
+    shared::bind(map, names[0], names[i]);
+  }
+}
+
+// n random edges, the same graph every run
+static void make_random(map_t & map, std::size_t n) {
+  create_vars(map, n);
+  const auto & names = keys(n);
+  std::mt19937_64 rng(42);
+  std::uniform_int_distribution<std::size_t> pick(0, n - 1);
+  for (std::size_t i = 0; i < n; i++) {
+    shared::bind(map, names[pick(rng)], names[pick(rng)]);
+  }
+}
+
+// Allocations per iteration and per var, next to the time
+static void report(benchmark::State& state, std::size_t allocations, std::size_t n) {
+  state.counters["allocs/op"] = benchmark::Counter(double(allocations), benchmark::Counter::kAvgIterations);
+  state.counters["allocs/var"] = benchmark::Counter(double(allocations) / double(n), benchmark::Counter::kAvgIterations);
+  state.SetComplexityN(std::int64_t(n));
+}
+
+// ===== bind =====
+
+// Builds a whole graph per iteration, the allocations include the creates
+template <void (*make_graph)(map_t &, std::size_t)>
+static void bind_graph(benchmark::State& state) {
+  const std::size_t n = std::size_t(state.range(0));
+  keys(n);
+
+  std::unique_ptr<map_t> map;
+  std::size_t allocations = 0;
+
+  // Code inside this loop is measured repeatedly
+  for (auto _ : state) {
+    // The previous map is destroyed outside the timing
+    state.PauseTiming();
+    map = std::make_unique<map_t>();
+    state.ResumeTiming();
+
+    const std::size_t before = allocation_stats.allocations;
+    make_graph(*map, n);
+    allocations += allocation_stats.allocations - before;
+  }
+
+  report(state, allocations, n);
+}
+// Register the function as a benchmark
+BENCHMARK(bind_graph<make_chain>)->Name("bind_chain")->RangeMultiplier(10)->Range(10, 1000000)->Unit(benchmark::kMillisecond)->Complexity();
+BENCHMARK(bind_graph<make_star>)->Name("bind_star")->RangeMultiplier(10)->Range(10, 1000000)->Unit(benchmark::kMillisecond)->Complexity();
+BENCHMARK(bind_graph<make_random>)->Name("bind_random")->RangeMultiplier(10)->Range(10, 1000000)->Unit(benchmark::kMillisecond)->Complexity();
+
+// Every new var takes the group of the existing chain: n^2 propagations
+static void make_chain_reversed(map_t & map, std::size_t n) {
+  create_vars(map, n);
+  const auto & names = keys(n);
+  for (std::size_t i = 0; i + 1 < n; i++) {
+    shared::bind(map, names[i + 1], names[i]);
+  }
+}
+BENCHMARK(bind_graph<make_chain_reversed>)->Name("bind_chain_reversed")->RangeMultiplier(10)->Range(10, 10000)->Unit(benchmark::kMillisecond)->Complexity();
+
+// Every pair of vars, n^2 edges
+static void make_clique(map_t & map, std::size_t n) {
+  create_vars(map, n);
+  const auto & names = keys(n);
+  for (std::size_t i = 0; i < n; i++) {
+    for (std::size_t j = i + 1; j < n; j++) {
+      shared::bind(map, names[i], names[j]);
+    }
+  }
+}
+BENCHMARK(bind_graph<make_clique>)->Name("bind_clique")->RangeMultiplier(10)->Range(10, 1000)->Unit(benchmark::kMillisecond)->Complexity();
+
+// ===== single var operations on a group =====
+
+// Builds the graph outside the timing, then measures one operation
+template <void (*make_graph)(map_t &, std::size_t), void (*operation)(map_t &, std::size_t)>
+static void group_operation(benchmark::State& state) {
+  const std::size_t n = std::size_t(state.range(0));
+  keys(n);
+
+  std::unique_ptr<map_t> map;
+  std::size_t allocations = 0;
+
+  // Code inside this loop is measured repeatedly
+  for (auto _ : state) {
+    // The previous map is destroyed outside the timing
+    state.PauseTiming();
+    map = std::make_unique<map_t>();
+    make_graph(*map, n);
+    state.ResumeTiming();
+
+    const std::size_t before = allocation_stats.allocations;
+    operation(*map, n);
+    allocations += allocation_stats.allocations - before;
+  }
+
+  report(state, allocations, n);
+}
+
+// Splits the chain in two halves
+static void unbind_middle(map_t & map, std::size_t n) {
+  const auto & names = keys(n);
+  shared::unbind(map, names[n / 2 - 1], names[n / 2]);
+}
+
+// The middle var leaves the chain, the halves get new groups
+static void isolate_middle(map_t & map, std::size_t n) {
+  shared::isolate(map, keys(n)[n / 2]);
+}
+
+static void remove_middle(map_t & map, std::size_t n) {
+  shared::remove(map, keys(n)[n / 2]);
+}
+
+// Every leaf gets its own group
+static void isolate_first(map_t & map, std::size_t n) {
+  shared::isolate(map, keys(n)[0]);
+}
+
+static void remove_first(map_t & map, std::size_t n) {
+  shared::remove(map, keys(n)[0]);
+}
+
+static void unbind_all(map_t & map, std::size_t) {
+  shared::unbind_all(map);
+}
+
+static void remove_all(map_t & map, std::size_t) {
+  shared::remove_all(map);
+}
+
+// Register the functions as benchmarks
+BENCHMARK(group_operation<make_chain, unbind_middle>)->Name("unbind_chain_middle")->RangeMultiplier(10)->Range(10, 1000000)->Unit(benchmark::kMicrosecond)->Complexity();
+BENCHMARK(group_operation<make_chain, isolate_middle>)->Name("isolate_chain_middle")->RangeMultiplier(10)->Range(10, 1000000)->Unit(benchmark::kMicrosecond)->Complexity();
+BENCHMARK(group_operation<make_chain, remove_middle>)->Name("remove_chain_middle")->RangeMultiplier(10)->Range(10, 1000000)->Unit(benchmark::kMicrosecond)->Complexity();
+BENCHMARK(group_operation<make_star, isolate_first>)->Name("isolate_star_center")->RangeMultiplier(10)->Range(10, 1000000)->Unit(benchmark::kMicrosecond)->Complexity();
+BENCHMARK(group_operation<make_star, remove_first>)->Name("remove_star_center")->RangeMultiplier(10)->Range(10, 1000000)->Unit(benchmark::kMicrosecond)->Complexity();
+BENCHMARK(group_operation<make_random, isolate_middle>)->Name("isolate_random")->RangeMultiplier(10)->Range(10, 1000000)->Unit(benchmark::kMicrosecond)->Complexity();
+BENCHMARK(group_operation<make_random, unbind_all>)->Name("unbind_all_random")->RangeMultiplier(10)->Range(10, 1000000)->Unit(benchmark::kMicrosecond)->Complexity();
+BENCHMARK(group_operation<make_random, remove_all>)->Name("remove_all_random")->RangeMultiplier(10)->Range(10, 1000000)->Unit(benchmark::kMicrosecond)->Complexity();
+
+// Run the benchmark
+BENCHMARK_MAIN();
@@ -0,0 +1,284 @@
+#include "../shared_var/shared_var.hpp"
+#include "../shared_var/shared_builder.hpp"
+#include "../shared_var/segmented_container.hpp"
+
+#include "counting_allocator.hpp"
+
+#include <iostream>
+#include <thread>
+
+// Counts the allocations from a memory resource
+class counting_resource_t : public std::pmr::memory_resource {
+public:
+    std::size_t allocations = 0;
+    std::size_t deallocations = 0;
+    
+private:
+    void * do_allocate(std::size_t bytes, std::size_t alignment) override {
+        allocations++;
+        return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+    }
+    
+    void do_deallocate(void * ptr, std::size_t bytes, std::size_t alignment) override {
+        deallocations++;
+        std::pmr::new_delete_resource()->deallocate(ptr, bytes, alignment);
+    }
+    
+    bool do_is_equal(const std::pmr::memory_resource & other) const noexcept override {
+        return this == &other;
+    }
+};
+
+struct vehicle_t {
+    virtual ~vehicle_t() = default;
+    virtual int wheels() const = 0;
+};
+
+struct car_t : public vehicle_t {
+    int wheels() const override { return 4; }
+};
+
+struct bus_t : public vehicle_t {
+    double seats[8] = {};
+    int wheels() const override { return 6; }
+};
+
+// Pooled objects are reset by the pool
+struct taxi_t : public vehicle_t {
+    int passengers = 0;
+    int resets = 0;
+    void reset() { passengers = 0; resets++; }
+    int wheels() const override { return 4; }
+};
+
+// Constructing again may throw, so they are not pooled
+struct shuttle_t : public vehicle_t {
+    static inline int alive = 0;
+    shuttle_t() { alive++; }
+    ~shuttle_t() override { alive--; }
+    int wheels() const override { return 4; }
+};
+
+struct tram_t : public vehicle_t {
+    static inline int alive = 0;
+    tram_t() noexcept { alive++; }
+    ~tram_t() override { alive--; }
+    void reset() {}
+    int wheels() const override { return 8; }
+};
+
+struct truck_t : public vehicle_t {
+    int axles;
+    explicit truck_t(int axles_) : axles(axles_) {}
+    int wheels() const override { return 4 * axles; }
+};
+
+// The builders before builder_t were plain function pointers
+vehicle_t * build_plain_car() {
+    return new car_t;
+}
+
+// A C++20 random access iterator, a legacy input iterator (it yields Base * by value)
+using batch_iterator_t = shared::builder::batch_t<vehicle_t>::iterator;
+static_assert(std::random_access_iterator<batch_iterator_t>);
+static_assert(std::is_same_v<std::iterator_traits<batch_iterator_t>::iterator_category, std::input_iterator_tag>);
+
+int main() {
+    shared::map_type<std::string> map;
+    
+    shared::make_builder<vehicle_t, car_t>(map, "car");
+    shared::make_builder<vehicle_t, bus_t>(map, "bus");
+    
+// ===== build_shared =====
+    
+    // The object and the control block in one allocation
+    std::size_t before = allocation_stats.allocations;
+    std::shared_ptr<vehicle_t> bus = shared::build_shared<vehicle_t>(map, "bus");
+    if(allocation_stats.allocations - before != 1) return 1;
+    if(bus == nullptr || bus->wheels() != 6) return 2;
+    
+    // Missing builders build nothing
+    if(shared::build_shared<vehicle_t>(map, "boat") != nullptr) return 3;
+    
+// ===== memory resources =====
+    
+    counting_resource_t resource;
+    
+    before = allocation_stats.allocations;
+    
+    {
+        auto car = shared::build_unique<vehicle_t>(map, "car", &resource);
+        if(car == nullptr || car->wheels() != 4) return 4;
+        
+        auto shared_bus = shared::build_shared<vehicle_t>(map, "bus", &resource);
+        if(shared_bus == nullptr || shared_bus->wheels() != 6) return 5;
+        
+        if(resource.allocations != 2) return 6;
+    }
+    
+    // Everything went back to the resource, nothing came from the global new
+    if(resource.deallocations != 2) return 7;
+    if(allocation_stats.allocations != before) return 8;
+    
+    if(shared::build_unique<vehicle_t>(map, "boat", &resource) != nullptr) return 9;
+    
+// ===== registry =====
+    
+    shared::builder::registry_t<vehicle_t> registry;
+    const auto id = registry.resolve(map, "car");
+    
+    before = allocation_stats.allocations;
+    if(registry.build_shared(id)->wheels() != 4) return 10;
+    if(allocation_stats.allocations - before != 1) return 11;
+    
+// ===== batches =====
+    
+    before = allocation_stats.allocations;
+    
+    {
+        shared::builder::batch_t<vehicle_t> buses = shared::build_n<vehicle_t>(map, "bus", 1000);
+        if(allocation_stats.allocations - before != 1) return 12;
+        if(buses.size() != 1000 || buses.stride() != sizeof(bus_t)) return 13;
+        
+        int wheels = 0;
+        
+        for(vehicle_t * vehicle : buses) {
+            wheels += vehicle->wheels();
+        }
+        
+        if(wheels != 6000) return 14;
+        
+        // The objects are contiguous
+        if(reinterpret_cast<std::byte *>(buses[999]) - reinterpret_cast<std::byte *>(buses[0]) != 999 * std::ptrdiff_t(sizeof(bus_t))) return 15;
+    }
+    
+    if(!shared::build_n<vehicle_t>(map, "boat", 10).empty()) return 16;
+    
+// ===== pools =====
+    
+    shared::make_builder<vehicle_t, taxi_t>(map, "taxi");
+    
+    taxi_t * first = nullptr;
+    
+    {
+        auto taxi = shared::build_pooled<vehicle_t>(map, "taxi");
+        first = static_cast<taxi_t *>(taxi.get());
+        first->passengers = 3;
+    }
+    
+    // The same object comes back, reset, without allocations
+    before = allocation_stats.allocations;
+    
+    for(int i = 0; i < 100; i++) {
+        auto taxi = shared::build_pooled<vehicle_t>(map, "taxi");
+        if(taxi.get() != first) return 17;
+        if(first->passengers != 0) return 18;
+        first->passengers = i;
+    }
+    
+    if(allocation_stats.allocations != before) return 19;
+    if(first->resets != 101) return 20;
+    
+    if(shared::build_pooled<vehicle_t>(map, "boat") != nullptr) return 21;
+    
+    shared::make_builder<vehicle_t, shuttle_t>(map, "shuttle");
+    
+    {
+        auto shuttle = shared::build_pooled<vehicle_t>(map, "shuttle");
+        if(shuttle == nullptr || shuttle_t::alive != 1) return 22;
+    }
+    
+    if(shuttle_t::alive != 0 || shared::builder::pool_t<shuttle_t>::local().size() != 0) return 23;
+    
+    // Objects released after the pool of their thread is destroyed are deleted
+    shared::make_builder<vehicle_t, tram_t>(map, "tram");
+    
+    std::thread([&map]() {
+        // Constructed before the pool, so destroyed after it
+        thread_local shared::builder::pooled_ptr<vehicle_t> late;
+        
+        auto early = shared::build_pooled<vehicle_t>(map, "tram");
+        late = shared::build_pooled<vehicle_t>(map, "tram");
+    }).join();
+    
+    if(tram_t::alive != 0) return 24;
+    
+// ===== segmented container =====
+    
+    {
+        shared::builder::segmented_t<vehicle_t> vehicles;
+        
+        for(int i = 0; i < 100; i++) {
+            vehicles.emplace(map, i % 2 == 0 ? "car" : "bus");
+        }
+        
+        if(vehicles.emplace(map, "boat") != nullptr) return 25;
+        if(vehicles.size() != 100 || vehicles.segment_count() != 2) return 26;
+        
+        // Type by type: every car, then every bus
+        int wheels = 0;
+        int switches = 0;
+        int last = 0;
+        
+        vehicles.for_each([&](vehicle_t & vehicle) {
+            if(vehicle.wheels() != last) switches++;
+            last = vehicle.wheels();
+            wheels += last;
+        });
+        
+        if(wheels != 50 * 4 + 50 * 6 || switches != 2) return 27;
+    }
+    
+// ===== plain function pointer builders =====
+    
+    // Stored like the old Base * (*)() builders
+    shared::create<shared::builder_type<vehicle_t>>(map, "plain car", &build_plain_car);
+    
+    shared::builder_type<vehicle_t> plain = shared::get<shared::builder_type<vehicle_t>>(map, "plain car");
+    if(plain == nullptr || !(shared::get<shared::builder_type<vehicle_t>>(map, "boat") == nullptr)) return 28;
+    
+    if(shared::build_unique<vehicle_t>(map, "plain car")->wheels() != 4) return 29;
+    if(shared::build_shared<vehicle_t>(map, "plain car")->wheels() != 4) return 30;
+    if(shared::build_pooled<vehicle_t>(map, "plain car")->wheels() != 4) return 31;
+    
+    // Without the Derived type, the memory resource and batch builds build nothing
+    if(shared::build_unique<vehicle_t>(map, "plain car", &resource) != nullptr) return 32;
+    if(!shared::build_n<vehicle_t>(map, "plain car", 2).empty()) return 33;
+    
+// ===== builders with arguments =====
+    
+    shared::make_arg_builder<vehicle_t, truck_t, int>(map, "truck");
+    
+    std::unique_ptr<vehicle_t> truck = shared::build_unique_with<vehicle_t, int>(map, "truck", 3);
+    if(truck == nullptr || truck->wheels() != 12) return 34;
+    
+    // Another signature is another type
+    if(shared::build_with<vehicle_t, long>(map, "truck", 3) != nullptr) return 35;
+    
+    // The state lives in the builder, building only allocates the object
+    const int extra_axles = 2;
+    shared::make_arg_builder_from<vehicle_t, int>(map, "long truck", [extra_axles](int axles) -> vehicle_t * {
+        return new truck_t(axles + extra_axles);
+    });
+    
+    before = allocation_stats.allocations;
+    truck = shared::build_unique_with<vehicle_t, int>(map, "long truck", 3);
+    if(allocation_stats.allocations - before != 1) return 36;
+    if(truck->wheels() != 20) return 37;
+    
+    // States that are not trivially copyable are copied with the var
+    shared::make_arg_builder_from<vehicle_t>(map, "named", [name = std::string(64, 'x')]() -> vehicle_t * {
+        return new truck_t(int(name.size()));
+    });
+    
+    auto snapshot = shared::snapshot(map);
+    shared::remove(map, "named");
+    shared::restore(map, snapshot);
+    
+    truck.reset(shared::build_with<vehicle_t>(map, "named"));
+    if(truck == nullptr || truck->wheels() != 256) return 38;
+    
+    std::cout << "OK\n";
+    
+    return 0;
+}
@@ -0,0 +1,117 @@
+#include "../shared_var/shared_var.hpp"
+#include "../shared_var/multithread.hpp"
+#include "../shared_var/coroutines.hpp"
+
+#include <coroutine>
+#include <iostream>
+#include <thread>
+
+// Minimal fire and forget coroutine
+struct task_t {
+    struct promise_type {
+        task_t get_return_object() { return {}; }
+        std::suspend_never initial_suspend() { return {}; }
+        std::suspend_never final_suspend() noexcept { return {}; }
+        void return_void() {}
+        void unhandled_exception() { std::terminate(); }
+    };
+};
+
+task_t wait_change(shared::var_view_t<int, shared::map_type<std::string>> & view, shared::coro::queue_executor_t & ex, int & result) {
+    const bool exists = co_await shared::coro::changed(view, ex);
+    result = exists ? int(view) : -1;
+}
+
+task_t wait_until(shared::map_type<std::string> & map, shared::coro::queue_executor_t & ex, int & result) {
+    const bool exists = co_await shared::coro::until<int>(map, "B", [](const int & value) { return value > 10; }, ex);
+    result = exists ? shared::get<int>(map, "B") : -1;
+}
+
+using ts_map_t = shared::thread_safe::ts_var_map_t<std::string>;
+
+task_t wait_until_ts(ts_map_t & map, shared::coro::queue_executor_t & ex, int & result) {
+    const bool exists = co_await shared::coro::until<int>(map, "T", [](const int & value) { return value >= 100; }, ex);
+    result = exists ? shared::thread_safe::get<int>(map, "T") : -1;
+}
+
+// Thread safe maps, the writer runs on another thread
+int test_thread_safe() {
+    ts_map_t map;
+    shared::coro::queue_executor_t ex;
+    
+    shared::thread_safe::create<int>(map, "T", 0);
+    
+    // A change between await_ready and await_suspend is not lost
+    auto awaiter = shared::coro::until<int>(map, "T", [](const int & value) { return value == 7; }, ex);
+    if(awaiter.await_ready()) return 10;
+    
+    shared::thread_safe::set<int>(map, "T", 7);
+    shared::thread_safe::notify(map, "T");
+    
+    if(awaiter.await_suspend(std::noop_coroutine())) return 11;
+    if(!awaiter.await_resume()) return 12;
+    
+    int result = 0;
+    wait_until_ts(map, ex, result);
+    
+    std::thread writer([&]() {
+        shared::thread_safe::ts_var_view_t<int, ts_map_t> T(map, "T");
+        
+        for(int value = 1; value <= 100; value++) {
+            T.set_and_notify(value);
+        }
+    });
+    writer.join();
+    
+    if(ex.run() != 1 || result != 100) return 13;
+    
+    return 0;
+}
+
+int main() {
+    shared::map_type<std::string> map;
+    shared::coro::queue_executor_t ex;
+    
+    auto A = shared::make_var<int>(map, "A", 0);
+    auto B = shared::make_var<int>(map, "B", 0);
+    
+    int result_A = 0;
+    int result_B = 0;
+    
+    wait_change(A, ex, result_A);
+    wait_until(map, ex, result_B);
+    
+    // Writing alone does not resume, the writer notifies
+    A = 5;
+    ex.run();
+    if(result_A != 0) return 1;
+    
+    A.notify();
+    if(ex.run() != 1 || result_A != 5) return 2;
+    
+    // The predicate is checked on every change
+    B.set_and_notify(3);
+    if(ex.run() != 0) return 3;
+    
+    // Bound vars share the memory, a change to "C" is a change to "B"
+    shared::bind(map, "B", "C");
+    shared::set<int>(map, "C", 42);
+    shared::notify(map, "C");
+    if(ex.run() != 1 || result_B != 42) return 4;
+    
+    // Removing the var resumes the waiters
+    wait_change(A, ex, result_A);
+    shared::remove(map, "A");
+    if(ex.run() != 1 || result_A != -1) return 5;
+    
+    // A var of another type is not read, the wait fails at once
+    shared::create<double>(map, "W", 1.0);
+    auto wrong_type = shared::coro::until<int>(map, "W", [](const int &) { return false; }, ex);
+    if(!wrong_type.await_ready() || wrong_type.await_resume()) return 6;
+    
+    if(const int error = test_thread_safe()) return error;
+    
+    std::cout << "ok\n";
+    
+    return 0;
+}
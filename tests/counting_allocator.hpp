@@ -0,0 +1,84 @@
+#ifndef SHARED_VAR_TESTS__COUNTING_ALLOCATOR_HPP
+#define SHARED_VAR_TESTS__COUNTING_ALLOCATOR_HPP
+
+// Replaces the global new and delete, counting the allocations and the bytes.
+// The replacement is program wide: include it in a single translation unit.
+
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+// GCC sees the replaced new paired with std::free, and the size header
+// read before inlined deletes, and warns from -O1
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#pragma GCC diagnostic ignored "-Warray-bounds"
+#endif
+
+// Every allocation done with the global new, and the bytes requested.
+// The size is stored before the block, so delete knows how much is freed.
+struct allocation_stats_t {
+    std::atomic<std::size_t> allocations = 0;
+    std::atomic<std::size_t> live_bytes = 0;
+    std::atomic<std::size_t> peak_bytes = 0;
+};
+
+inline allocation_stats_t allocation_stats;
+inline constexpr std::size_t allocation_header_size = alignof(std::max_align_t);
+
+void * operator new(std::size_t size) {
+    void * block = std::malloc(size + allocation_header_size);
+    if(block == nullptr) throw std::bad_alloc();
+    *static_cast<std::size_t *>(block) = size;
+    
+    allocation_stats.allocations.fetch_add(1, std::memory_order_relaxed);
+    const std::size_t live = allocation_stats.live_bytes.fetch_add(size, std::memory_order_relaxed) + size;
+    
+    std::size_t peak = allocation_stats.peak_bytes.load(std::memory_order_relaxed);
+    while(live > peak && !allocation_stats.peak_bytes.compare_exchange_weak(peak, live, std::memory_order_relaxed)) {}
+    
+    return static_cast<char *>(block) + allocation_header_size;
+}
+
+void operator delete(void * ptr) noexcept {
+    if(ptr == nullptr) return;
+    void * block = static_cast<char *>(ptr) - allocation_header_size;
+    allocation_stats.live_bytes.fetch_sub(*static_cast<std::size_t *>(block), std::memory_order_relaxed);
+    std::free(block);
+}
+
+void operator delete(void * ptr, std::size_t) noexcept {
+    operator delete(ptr);
+}
+
+// Measures the allocations of a region, the peak is relative to the start
+class allocation_scope_t {
+public:
+    allocation_scope_t() :
+        allocations_(allocation_stats.allocations.load()),
+        live_bytes_(allocation_stats.live_bytes.load())
+    {
+        allocation_stats.peak_bytes.store(live_bytes_);
+    }
+    
+    std::size_t allocations() const {
+        return allocation_stats.allocations.load() - allocations_;
+    }
+    
+    // Bytes still allocated, may be negative when the region frees memory
+    double retained_bytes() const {
+        return double(allocation_stats.live_bytes.load()) - double(live_bytes_);
+    }
+    
+    std::size_t peak_bytes() const {
+        return allocation_stats.peak_bytes.load() - live_bytes_;
+    }
+    
+private:
+    std::size_t allocations_;
+    std::size_t live_bytes_;
+};
+
+
+#endif // SHARED_VAR_TESTS__COUNTING_ALLOCATOR_HPP
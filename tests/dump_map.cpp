@@ -0,0 +1,161 @@
+#include "../shared_var/shared_var.hpp"
+#include "../shared_var/debug_tools.hpp"
+#include "../shared_var/topology_export.hpp"
+
+#include <iostream>
+#include <sstream>
+
+// Types with a to_string member are formatted with it
+struct point_t {
+    int x = 0;
+    int y = 0;
+    
+    std::string to_string() const {
+        return std::to_string(x) + ";" + std::to_string(y);
+    }
+};
+
+// Types without a conversion
+struct opaque_t {
+    int value = 0;
+};
+
+// Keys without a conversion, written by operator <<
+struct slot_t {
+    int index = 0;
+    
+    auto operator <=>(const slot_t &) const = default;
+};
+
+std::ostream & operator <<(std::ostream & stream, const slot_t & slot) {
+    return stream << "slot " << slot.index;
+}
+
+int main() {
+    shared::map_type<std::string> map;
+    
+    shared::create<int>(map, "A", -12);
+    shared::create<double>(map, "B", 0.5);
+    shared::create<std::string>(map, "C", "say \"hi\", bye");
+    shared::create<point_t>(map, "D", point_t{1, 2});
+    shared::create<opaque_t>(map, "E");
+    shared::create<bool>(map, "F", true);
+    shared::bind(map, "A", "G");
+    
+    const std::string csv = shared::debug::dump(map, shared::debug::DUMP_CSV);
+    
+    if(csv.find("key,value,group,type\n") != 0) return 1;
+    if(csv.find("\nA,-12,A,") == std::string::npos) return 2;
+    if(csv.find("\nB,0.5,B,") == std::string::npos) return 3;
+    if(csv.find("\nC,\"say \"\"hi\"\", bye\",C,") == std::string::npos) return 4;
+    if(csv.find("\nD,1;2,D,") == std::string::npos) return 5;
+    if(csv.find("\nE,[unknown type],E,") == std::string::npos) return 6;
+    if(csv.find("\nF,true,F,") == std::string::npos) return 7;
+    
+    // References share the group
+    if(csv.find("\nG,-12,A,") == std::string::npos) return 8;
+    
+    const std::string json = shared::debug::dump(map, shared::debug::DUMP_JSON_LINES);
+    
+    if(json.find("{\"key\":\"C\",\"value\":\"say \\\"hi\\\", bye\",\"group\":\"C\",") == std::string::npos) return 9;
+    
+    // One line per var
+    std::size_t lines = 0;
+    for(const char c : json) lines += c == '\n';
+    if(lines != map.size()) return 10;
+    
+    // Snapshots keep the formatter.
+    // Restore doesn't keep the refs, so the re-created G has its own group
+    auto data = shared::snapshot(map);
+    map.clear();
+    shared::restore(map, data);
+    
+    std::string restored_csv = csv;
+    restored_csv.replace(restored_csv.find("\nG,-12,A,"), 9, "\nG,-12,G,");
+    if(shared::debug::dump(map, shared::debug::DUMP_CSV) != restored_csv) return 11;
+    
+// ===== topology =====
+    
+    shared::create<int>(map, "net.x", 1);
+    shared::create<int>(map, "net.y", 2);
+    shared::bind(map, "net.x", "net.y");
+    shared::bind(map, "net.y", "A");
+    
+    // Restore doesn't keep the refs
+    shared::bind(map, "A", "G");
+    
+    std::ostringstream dot;
+    shared::debug::export_topology(map, dot);
+    
+    // Refs are symmetric, each edge once
+    if(dot.str().find("graph shared {\n") != 0) return 12;
+    if(dot.str().find("\"A\" -- \"G\";") == std::string::npos) return 13;
+    if(dot.str().find("\"G\" -- \"A\";") != std::string::npos) return 14;
+    if(dot.str().find("\"net.x\" -- \"net.y\";") == std::string::npos) return 15;
+    if(dot.str().find(", views=0, observers=0];") == std::string::npos) return 16;
+    
+    // Only the prefix, edges leaving it are kept
+    std::ostringstream prefixed;
+    shared::debug::topology_filter_t<std::string> filter;
+    filter.prefix = "net.";
+    shared::debug::export_topology(map, prefixed, shared::debug::TOPOLOGY_JSON_LINES, filter);
+    
+    if(prefixed.str().find("{\"node\":\"net.x\"") != 0) return 17;
+    if(prefixed.str().find("{\"node\":\"A\"") != std::string::npos) return 18;
+    if(prefixed.str().find("{\"edge\":[\"net.x\",\"net.y\"]}") == std::string::npos) return 19;
+    if(prefixed.str().find("{\"edge\":[\"net.y\",\"A\"]}") == std::string::npos) return 20;
+    
+    // Only the group
+    std::ostringstream group;
+    filter = {};
+    filter.group = "G";
+    shared::debug::export_topology(map, group, shared::debug::TOPOLOGY_JSON_LINES, filter);
+    
+    std::size_t nodes = 0;
+    for(std::size_t pos = 0; (pos = group.str().find("{\"node\"", pos)) != std::string::npos; pos++) nodes++;
+    if(nodes != 4) return 21;
+    
+    // T keeps the group id "S" after leaving, S has a group of its own
+    shared::create<int>(map, "R", 1);
+    shared::create<int>(map, "S", 2);
+    shared::create<int>(map, "T", 3);
+    shared::bind(map, "R", "T");
+    shared::bind(map, "S", "R");
+    shared::unbind(map, "T", "R");
+    shared::unbind(map, "S", "R");
+    
+    std::ostringstream split;
+    filter.group = "S";
+    shared::debug::export_topology(map, split, shared::debug::TOPOLOGY_JSON_LINES, filter);
+    
+    if(map.find("T")->second.group_id != map.find("S")->second.group_id) return 22;
+    if(split.str().find("{\"node\":\"S\"") != 0) return 23;
+    if(split.str().find("{\"node\":\"T\"") != std::string::npos) return 24;
+    
+    // The group of a missing var is empty
+    std::ostringstream missing;
+    filter.group = "missing";
+    shared::debug::export_topology(map, missing, shared::debug::TOPOLOGY_JSON_LINES, filter);
+    if(!missing.str().empty()) return 25;
+    
+    // char prints as a character
+    shared::create<char>(map, "ch", 'x');
+    if(shared::debug::dump(map, shared::debug::DUMP_CSV).find("\nch,x,ch,") == std::string::npos) return 26;
+    
+    shared::debug::print_map(map);
+    
+    // print_map writes the other keys with operator <<
+    shared::map_type<slot_t> slot_map;
+    shared::create<std::string>(slot_map, slot_t{7}, "seven");
+    
+    std::ostringstream printed;
+    std::streambuf * cout_buffer = std::cout.rdbuf(printed.rdbuf());
+    shared::debug::print_map(slot_map);
+    std::cout.rdbuf(cout_buffer);
+    
+    if(printed.str().find("slot 7:        \"seven\" of group slot 7 and type ") == std::string::npos) return 27;
+    
+    std::cout << "OK\n";
+    
+    return 0;
+}
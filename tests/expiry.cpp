@@ -0,0 +1,75 @@
+#include "../shared_var/shared_var.hpp"
+#include "../shared_var/expiry.hpp"
+#include "../shared_var/multithread.hpp"
+
+#include <iostream>
+
+int main() {
+    shared::map_type<std::string> map;
+    shared::expiry::expiry_t expiry(map);
+    
+    shared::create<int>(map, "session", 1);
+    shared::create<int>(map, "cache", 2);
+    shared::create<int>(map, "config", 3);
+    
+    if(expiry.expire_after("missing", 5)) return 1;
+    if(!expiry.expire_after("session", 3)) return 2;
+    if(!expiry.expire_after("cache", 3)) return 3;
+    if(expiry.size() != 2 || !expiry.expires("session")) return 4;
+    
+    // Removed at the time to live tick, not before
+    if(expiry.advance(2) != 0 || !map.contains("session")) return 5;
+    
+    // Refreshing the time to live, and cancelling it
+    expiry.expire_after("cache", 3);
+    expiry.persist("session");
+    if(expiry.expires("session")) return 6;
+    
+    if(expiry.advance(1) != 0 || !map.contains("session") || !map.contains("cache")) return 7;
+    if(expiry.advance_to(expiry.now() + 1) != 0 || !map.contains("cache")) return 8;
+    if(expiry.advance(1) != 1 || map.contains("cache")) return 9;
+    if(expiry.size() != 0) return 10;
+    
+    // Removed by other means, the timer is cancelled
+    expiry.expire_after("config", 1);
+    shared::remove(map, "config");
+    if(expiry.expires("config")) return 11;
+    
+    shared::create<int>(map, "config", 4);
+    if(expiry.advance(1) != 0 || !map.contains("config")) return 12;
+    
+    // A bound var leaves its group (pin == wire == probe),
+    // the rest of the group keeps the value, the binds and the views
+    shared::create<int>(map, "pin", 7);
+    shared::bind(map, "pin", "wire");
+    shared::bind(map, "wire", "probe");
+    auto wire = shared::make_var<int>(map, "wire");
+    
+    expiry.expire_after("pin", 2);
+    if(expiry.advance(2) != 1 || map.contains("pin")) return 13;
+    if(!map.contains("wire") || !map.contains("probe") || wire != 7) return 14;
+    
+    wire = 9;
+    if(shared::get<int>(map, "probe") != 9) return 15;
+    
+    // Thread safe maps
+    shared::thread_safe::ts_var_map_t<std::string> ts_map;
+    shared::thread_safe::create<int>(ts_map, "token", 1);
+    shared::thread_safe::create<int>(ts_map, "user", 2);
+    
+    {
+        shared::expiry::expiry_t ts_expiry(ts_map);
+        
+        ts_expiry.expire_after("token", 1);
+        ts_expiry.expire_after("user", 5);
+        shared::thread_safe::remove(ts_map, "user");
+        if(ts_expiry.expires("user")) return 16;
+        
+        if(ts_expiry.advance_to(1) != 1 || shared::thread_safe::contains_key(ts_map, "token")) return 17;
+    }
+    
+    if(!ts_map.observers().empty()) return 18;
+    
+    std::cout << "expiry OK\n";
+    return 0;
+}
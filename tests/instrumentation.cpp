@@ -0,0 +1,145 @@
+#define SHARED_VAR_INSTRUMENTATION
+
+#include "../shared_var/shared_var.hpp"
+#include "../shared_var/multithread.hpp"
+#include "../shared_var/atomic_wrapper.hpp"
+#include "../shared_var/key_profiler.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <thread>
+
+// thread_safe::set writes under the read lock, the value itself is atomic
+using value_t = shared::atomic::atomic_wrapper_t<int>;
+
+int main() {
+    namespace instr = shared::instrumentation;
+    
+// ===== histogram buckets =====
+    
+    // Every value falls in the bucket starting at or below it, within 1/16
+    for(std::uint64_t value : {0ull, 1ull, 15ull, 16ull, 17ull, 1000ull, 123456789ull, ~0ull}) {
+        const std::uint64_t low = instr::histogram_layout_t::value_of(instr::histogram_layout_t::index_of(value));
+        if(low > value || value - low > value / 16) return 1;
+    }
+    
+    instr::histogram_t histogram;
+    for(std::uint64_t i = 1; i <= 1000; i++) histogram.add(i);
+    
+    if(histogram.count() != 1000 || histogram.max() != 1000) return 2;
+    if(histogram.percentile(50) < 500 || histogram.percentile(50) > 500 + 500 / 16) return 3;
+    if(histogram.percentile(100) != 1000) return 4;
+    
+// ===== counters =====
+    
+    instr::reset();
+    
+    shared::map_type<std::string> map;
+    shared::create<int>(map, "A", 1);
+    shared::create<int>(map, "B", 2);
+    shared::create<int>(map, "C", 3);
+    
+    {
+        auto view = shared::make_var<int>(map, "B");
+        
+        instr::reset();
+        
+        // B joins the group of A, its view moves to the new address
+        shared::bind(map, "A", "B");
+        shared::bind(map, "B", "C");
+        
+        auto counts = instr::report();
+        if(counts[instr::BINDS] != 2) return 5;
+        if(counts[instr::PROPAGATIONS] < 2) return 6;
+        if(counts[instr::SUBSCRIBER_UPDATES] != 1) return 7;
+    }
+    
+    instr::reset();
+    
+    for(int i = 0; i < 10; i++) {
+        shared::get<int>(map, "A");
+    }
+    
+    shared::create<int>(map, "D", 4);
+    
+    auto counts = instr::report();
+    if(counts[instr::LOOKUPS] != 10) return 8;
+    if(counts[instr::CREATES] != 1 || counts[instr::ALLOCATIONS] != 1) return 9;
+    
+// ===== locks =====
+    
+    instr::reset();
+    
+    shared::thread_safe::ts_var_map_t<std::string> ts_map;
+    shared::thread_safe::create<value_t>(ts_map, "X", 0);
+    
+    // Threads that exit keep their counts
+    std::thread worker([&]() {
+        for(int i = 0; i < 100; i++) {
+            shared::thread_safe::set<value_t>(ts_map, "X", i);
+        }
+    });
+    
+    for(int i = 0; i < 100; i++) {
+        shared::thread_safe::get<value_t>(ts_map, "X");
+    }
+    
+    worker.join();
+    
+    counts = instr::report();
+    if(counts[instr::LOCK_ACQUISITIONS] != 201) return 10;
+    if(counts[instr::LOCK_WAIT_NS].count() != 201) return 11;
+    if(counts[instr::LOCK_HOLD_NS].count() != 201) return 12;
+    
+// ===== hot keys =====
+    
+    {
+        shared::map_type<std::string> hot_map;
+        
+        for(int i = 0; i < 64; i++) {
+            shared::create<int>(hot_map, "var" + std::to_string(i), i);
+        }
+        
+        instr::key_profiler_t profiler(hot_map, 4, 8);
+        
+        // "var7" gets half of the lookups
+        for(int i = 0; i < 64000; i++) {
+            shared::get<int>(hot_map, (i % 2 == 0) ? std::string("var7") : "var" + std::to_string(i % 64));
+        }
+        
+        const auto top = profiler.top();
+        if(top.size() != 4 || top.front().key != "var7") return 13;
+        if(profiler.accesses("var7") < 32000) return 14;
+    }
+    
+    // The hook is detached when the profiler is destroyed
+    if(map.lookup_hook().callback != nullptr) return 15;
+    
+// ===== contended keys =====
+    
+    {
+        instr::key_profiler_t profiler(ts_map);
+        
+        std::atomic<bool> locked = false;
+        std::thread holder([&]() {
+            [[maybe_unused]] auto lock = shared::impl::lock_map(ts_map);
+            locked = true;
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        });
+        
+        while(!locked) {
+            std::this_thread::yield();
+        }
+        
+        shared::thread_safe::get<value_t>(ts_map, "X");
+        holder.join();
+        
+        if(profiler.contentions("X") < 1) return 16;
+        if(profiler.top_contended().empty() || profiler.top_contended().front().key != "X") return 17;
+    }
+    
+    std::cout << "OK\n";
+    
+    return 0;
+}
@@ -0,0 +1,90 @@
+#include "../shared_var/shared_var.hpp"
+#include "../shared_var/multithread.hpp"
+#include "../shared_var/memory_stats.hpp"
+
+#include <iostream>
+
+static void over_budget(void * context, const shared::memory::stats_t &, std::size_t) {
+    (*reinterpret_cast<int *>(context))++;
+}
+
+int main() {
+    shared::map_type<std::string> map;
+    
+    // Empty maps use nothing
+    if(shared::memory::memory_stats(map).total() != 0) return 1;
+    
+    shared::create<double>(map, "A", 1.0);
+    shared::create<double>(map, "B", 2.0);
+    shared::create<int>(map, "C", 3);
+    
+    auto stats = shared::memory::memory_stats(map);
+    if(stats.vars != 3 || stats.groups != 3) return 2;
+    if(stats.adjacency != 0 || stats.subscribers != 0) return 3;
+    if(stats.values < 2 * sizeof(double) + sizeof(int)) return 4;
+    
+    // A bound group shares a single value
+    shared::bind(map, "A", "B");
+    
+    const auto bound = shared::memory::memory_stats(map);
+    if(bound.vars != 3 || bound.groups != 2) return 5;
+    if(bound.values >= stats.values) return 6;
+    if(bound.adjacency == 0) return 7;
+    
+    // Views are subscribers
+    {
+        auto view = shared::make_var<int>(map, "C");
+        if(shared::memory::memory_stats(map).subscribers == 0) return 8;
+    }
+    
+    // Long keys own heap buffers
+    const auto before = shared::memory::memory_stats(map).keys;
+    shared::create<int>(map, std::string(100, 'k'), 0);
+    if(shared::memory::memory_stats(map).keys < before + 3 * 100) return 9;
+    
+    // The categories add up
+    const auto by_group = shared::memory::memory_stats_by_group(map);
+    const auto by_type = shared::memory::memory_stats_by_type(map);
+    
+    shared::memory::stats_t group_sum;
+    for(const auto & [group, group_stats] : by_group) group_sum += group_stats;
+    
+    shared::memory::stats_t type_sum;
+    for(const auto & [type, type_stats] : by_type) type_sum += type_stats;
+    
+    const auto total = shared::memory::memory_stats(map).total();
+    if(group_sum.total() != total || type_sum.total() != total) return 10;
+    if(by_group.size() != 3 || by_type.size() != 2) return 11;
+    
+    // Budgets
+    int calls = 0;
+    shared::memory::budget_t budget(map, total, &over_budget, &calls);
+    if(!budget.check() || calls != 0) return 12;
+    
+    shared::create<int>(map, "D", 4);
+    if(budget.check() || calls != 1) return 13;
+    
+    // Thread safe maps are locked for reading
+    shared::thread_safe::ts_var_map_t<std::string> ts_map;
+    shared::thread_safe::create<int>(ts_map, "A", 1);
+    if(shared::memory::memory_stats(ts_map).vars != 1) return 14;
+    
+    // T keeps the group id "S" after leaving, S has a group of its own
+    shared::map_type<std::string> split_map;
+    shared::create<int>(split_map, "R", 1);
+    shared::create<int>(split_map, "S", 2);
+    shared::create<int>(split_map, "T", 3);
+    shared::bind(split_map, "R", "T");
+    shared::bind(split_map, "S", "R");
+    shared::unbind(split_map, "T", "R");
+    shared::unbind(split_map, "S", "R");
+    
+    const auto split = shared::memory::memory_stats_by_group(split_map);
+    if(split.size() != 3) return 15;
+    if(split[1].group_id != "S" || split[2].group_id != "S") return 16;
+    if(split[1].stats.vars != 1 || split[2].stats.vars != 1) return 17;
+    
+    std::cout << "OK\n";
+    
+    return 0;
+}
@@ -0,0 +1,140 @@
+#define SHARED_VAR_INSTRUMENTATION
+
+#include "../shared_var/shared_var.hpp"
+#include "../shared_var/multithread.hpp"
+#include "../shared_var/metrics_export.hpp"
+
+#include <filesystem>
+#include <iostream>
+#include <sstream>
+
+static void save_text(void * context, std::string_view text) {
+    *reinterpret_cast<std::string *>(context) = text;
+}
+
+static bool has_line(const std::string & text, const std::string & line) {
+    std::istringstream stream(text);
+    
+    for(std::string current; std::getline(stream, current);) {
+        if(current == line) return true;
+    }
+    
+    return false;
+}
+
+int main() {
+// ===== map gauges =====
+    
+    shared::map_type<std::string> map;
+    
+    shared::create<int>(map, "A", 1);
+    shared::create<int>(map, "B", 2);
+    shared::create<int>(map, "C", 3);
+    shared::create<int>(map, "D", 4);
+    shared::bind(map, "A", "B");
+    shared::bind(map, "A", "C");
+    
+    int * view = shared::get_ptr<int>(map, "D");
+    map["D"].pointers_to_var.insert(reinterpret_cast<void **>(&view));
+    
+    const auto stats = shared::metrics::map_stats(map);
+    if(stats.vars != 4 || stats.groups != 2 || stats.largest_group != 3) return 1;
+    if(stats.subscribers != 1 || stats.observers != 0) return 2;
+    
+    map["D"].pointers_to_var.clear();
+    
+    const std::string text = shared::metrics::write_prometheus(map, "main \"map\"");
+    
+    if(!has_line(text, "# TYPE shared_var_vars gauge")) return 3;
+    if(!has_line(text, "shared_var_vars{map=\"main \\\"map\\\"\"} 4")) return 4;
+    if(!has_line(text, "shared_var_largest_group_vars{map=\"main \\\"map\\\"\"} 3")) return 5;
+    if(!has_line(text, "shared_var_creates_total 4")) return 6;
+    if(!has_line(text, "shared_var_allocations_total 4")) return 7;
+    if(text.back() != '\n') return 8;
+    
+    // D keeps the group id "B" after leaving, B has a group of its own
+    shared::map_type<std::string> split_map;
+    shared::create<int>(split_map, "A", 1);
+    shared::create<int>(split_map, "B", 2);
+    shared::create<int>(split_map, "D", 3);
+    shared::bind(split_map, "A", "D");
+    shared::bind(split_map, "B", "A");
+    shared::unbind(split_map, "D", "A");
+    shared::unbind(split_map, "B", "A");
+    
+    if(split_map["D"].group_id != split_map["B"].group_id) return 9;
+    if(shared::metrics::map_stats(split_map).groups != 3) return 10;
+    
+    // Several maps, every metric written once
+    const std::vector<std::pair<const shared::map_type<std::string> *, std::string_view>> maps = {{&map, "main"}, {&split_map, "split"}};
+    std::string both_text;
+    shared::metrics::write_prometheus(both_text, maps);
+    
+    if(!has_line(both_text, "shared_var_vars{map=\"main\"} 4") || !has_line(both_text, "shared_var_vars{map=\"split\"} 3")) return 11;
+    if(both_text.find("# TYPE shared_var_vars gauge") != both_text.rfind("# TYPE shared_var_vars gauge")) return 12;
+    if(both_text.find("\nshared_var_creates_total ") != both_text.rfind("\nshared_var_creates_total ")) return 13;
+    
+// ===== durations =====
+    
+    shared::instrumentation::reset();
+    
+    auto data = shared::snapshot(map);
+    shared::restore(map, data);
+    
+    shared::thread_safe::ts_var_map_t<std::string> ts_map;
+    shared::thread_safe::create<int>(ts_map, "X", 0);
+    
+    const std::string ts_text = shared::metrics::write_prometheus(ts_map, "ts");
+    
+    if(!has_line(ts_text, "shared_var_snapshot_seconds_count 1")) return 12;
+    if(!has_line(ts_text, "shared_var_restore_seconds_count 1")) return 13;
+    if(!has_line(ts_text, "# TYPE shared_var_lock_wait_seconds summary")) return 14;
+    if(ts_text.find("shared_var_lock_wait_seconds{quantile=\"0.99\"} ") == std::string::npos) return 15;
+    if(ts_text.find("shared_var_lock_contentions_total ") == std::string::npos) return 16;
+    
+// ===== periodic export =====
+    
+    shared::timer::timer_wheel_t wheel;
+    std::string received;
+    
+    {
+        shared::metrics::exporter_t exporter(map, wheel, 10, &save_text, &received, "main");
+        
+        wheel.advance(9);
+        if(exporter.exports() != 0 || !received.empty()) return 17;
+        
+        wheel.advance(1);
+        if(exporter.exports() != 1 || !has_line(received, "shared_var_vars{map=\"main\"} 4")) return 18;
+        
+        shared::create<int>(map, "E", 5);
+        wheel.advance(25);
+        if(exporter.exports() != 3 || !has_line(received, "shared_var_vars{map=\"main\"} 5")) return 19;
+    }
+    
+    // The destroyed exporter left no timer behind
+    if(wheel.advance(100) != 0) return 20;
+    
+// ===== file export =====
+    
+    const std::string path = (std::filesystem::temp_directory_path() / "shared_var_metrics_test.prom").string();
+    
+    {
+        shared::metrics::exporter_t exporter(map, wheel, 5, path, "main");
+        wheel.advance(5);
+        
+        if(exporter.exports() != 1 || exporter.failures() != 0) return 21;
+    }
+    
+    std::ifstream file(path);
+    std::stringstream contents;
+    contents << file.rdbuf();
+    
+    if(!has_line(contents.str(), "shared_var_vars{map=\"main\"} 5")) return 22;
+    if(std::filesystem::exists(path + ".tmp")) return 23;
+    
+    std::filesystem::remove(path);
+    
+    std::cout << "OK\n";
+    
+    return 0;
+}
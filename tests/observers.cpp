@@ -0,0 +1,103 @@
+#include "../shared_var/shared_var.hpp"
+
+#include <iostream>
+
+using map_t = shared::map_type<std::string>;
+
+// Counts the calls, runs "action" on the first one
+struct probe_t {
+    map_t * map = nullptr;
+    int calls = 0;
+    void (*action)(probe_t & self) = nullptr;
+    probe_t * other = nullptr;
+    
+    static bool on_event(void * context, const shared::info_t<std::string> &, shared::event_t) {
+        probe_t & self = *reinterpret_cast<probe_t *>(context);
+        
+        if(self.calls++ == 0 && self.action != nullptr) {
+            self.action(self);
+        }
+        
+        return true;
+    }
+};
+
+int main() {
+    map_t map;
+    shared::create<int>(map, "A", 0);
+    shared::create<int>(map, "B", 0);
+    
+    // Unregistering itself from the callback, while returning true
+    probe_t self_remove{&map};
+    self_remove.action = [](probe_t & self) {
+        shared::unobserve(*self.map, "A", &probe_t::on_event, &self);
+    };
+    shared::observe(map, "A", &probe_t::on_event, &self_remove);
+    
+    shared::notify(map, "A");
+    shared::notify(map, "A");
+    if(self_remove.calls != 1) return 1;
+    if(!map["A"].observers.empty()) return 2;
+    
+    // Unregistering an observer not called yet
+    probe_t later{&map};
+    probe_t first{&map};
+    first.other = &later;
+    first.action = [](probe_t & self) {
+        shared::unobserve(*self.map, "A", &probe_t::on_event, self.other);
+    };
+    shared::observe(map, "A", &probe_t::on_event, &first);
+    shared::observe(map, "A", &probe_t::on_event, &later);
+    
+    shared::notify(map, "A");
+    if(first.calls != 1 || later.calls != 0) return 3;
+    if(map["A"].observers.size() != 1) return 4;
+    
+    shared::unobserve(map, "A", &probe_t::on_event, &first);
+    
+    // Map observers unregistered by a var observer
+    probe_t map_observer{&map};
+    probe_t var_observer{&map};
+    var_observer.other = &map_observer;
+    var_observer.action = [](probe_t & self) {
+        shared::unobserve_map(*self.map, &probe_t::on_event, self.other);
+    };
+    shared::observe_map(map, &probe_t::on_event, &map_observer);
+    shared::observe(map, "B", &probe_t::on_event, &var_observer);
+    
+    shared::notify(map, "B");
+    if(map_observer.calls != 0 || !map.observers().empty()) return 5;
+    
+    // Map observers unregistering themselves while other vars are notified
+    probe_t nested_map{&map};
+    nested_map.action = [](probe_t & self) {
+        shared::notify(*self.map, "B");
+        shared::unobserve_map(*self.map, &probe_t::on_event, &self);
+    };
+    shared::observe_map(map, &probe_t::on_event, &nested_map);
+    
+    // The detached list is not called again by the nested notify
+    shared::notify(map, "A");
+    if(nested_map.calls != 1) return 6;
+    
+    shared::notify(map, "A");
+    if(nested_map.calls != 1 || !map.observers().empty()) return 7;
+    
+    // Observers registered by a callback are kept, called from the next change
+    probe_t added{&map};
+    probe_t adder{&map};
+    adder.other = &added;
+    adder.action = [](probe_t & self) {
+        shared::observe(*self.map, "A", &probe_t::on_event, self.other);
+    };
+    shared::observe(map, "A", &probe_t::on_event, &adder);
+    
+    shared::notify(map, "A");
+    if(added.calls != 0 || map["A"].observers.size() != 2) return 8;
+    
+    shared::notify(map, "A");
+    if(added.calls != 1 || adder.calls != 2) return 9;
+    
+    std::cout << "observers OK\n";
+    return 0;
+}
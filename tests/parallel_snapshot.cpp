@@ -0,0 +1,184 @@
+#include "../shared_var/shared_var.hpp"
+#include "../shared_var/multithread.hpp"
+#include "../shared_var/parallel_snapshot.hpp"
+#include "../shared_var/debug_tools.hpp"
+
+#include <atomic>
+#include <iostream>
+#include <stdexcept>
+
+// Enough vars for 4 threads
+constexpr int var_count = 4 * int(shared::parallel::min_vars_per_thread) + 123;
+
+// Copies of a type that fails to copy after the first "limit" copies
+struct fragile_t {
+    inline static std::atomic<int> copies = 0;
+    inline static int limit = 1 << 30;
+    
+    int value = 0;
+    
+    fragile_t() = default;
+    
+    fragile_t(const fragile_t & other) = default;
+    
+    fragile_t & operator =(const fragile_t & other) {
+        if(copies++ >= limit) throw std::runtime_error("fragile_t");
+        value = other.value;
+        return *this;
+    }
+};
+
+template <typename Map>
+void populate(Map & map) {
+    for(int i = 0; i < var_count; i++) {
+        const std::string key = "V" + std::to_string(i);
+        
+        if(i % 3 == 0) {
+            shared::create<std::string>(map, key, "text " + std::to_string(i));
+        }
+        else {
+            shared::create<int>(map, key, i);
+        }
+    }
+    
+    // Groups spread over the whole key range
+    for(int i = 1; i + 1000 < var_count; i += 97) {
+        shared::bind(map, "V" + std::to_string(i), "V" + std::to_string(i + 1000));
+    }
+}
+
+template <typename Map>
+void mutate(Map & map) {
+    for(int i = 0; i < var_count; i += 5) {
+        const std::string key = "V" + std::to_string(i);
+        
+        if(i % 3 == 0) {
+            shared::set<std::string>(map, key, "changed");
+        }
+        else {
+            shared::set<int>(map, key, -i);
+        }
+    }
+    
+    // Removed and retyped vars
+    for(int i = 2; i < var_count; i += 11) {
+        shared::remove(map, "V" + std::to_string(i));
+    }
+    
+    for(int i = 4; i < var_count; i += 13) {
+        shared::create<double>(map, "V" + std::to_string(i), 0.5, true);
+    }
+    
+    // Vars created after the snapshot are kept
+    shared::create<int>(map, "new", 7);
+}
+
+int main() {
+    shared::map_type<std::string> serial_map;
+    shared::map_type<std::string> parallel_map;
+    
+    populate(serial_map);
+    populate(parallel_map);
+    
+    // Same snapshot as shared::snapshot
+    auto serial_data = shared::snapshot(serial_map);
+    auto parallel_data = shared::parallel::snapshot(parallel_map, 4);
+    
+    if(parallel_data.size() != serial_data.size()) return 1;
+    
+    for(std::size_t i = 0; i < serial_data.size(); i++) {
+        if(parallel_data[i].key != serial_data[i].key) return 2;
+        if(parallel_data[i].type_id != serial_data[i].type_id) return 3;
+        if(parallel_data[i].ptr == nullptr) return 4;
+        if(parallel_data[i].ptr == parallel_map[parallel_data[i].key].ptr) return 5;
+    }
+    
+    const std::string original = shared::debug::dump(serial_map, shared::debug::DUMP_CSV);
+    if(shared::debug::dump(parallel_map, shared::debug::DUMP_CSV) != original) return 6;
+    
+    // Views of vars kept by the restore still see the values
+    auto view = shared::make_var<int>(parallel_map, "V1");
+    
+    mutate(serial_map);
+    mutate(parallel_map);
+    
+    // Same map as shared::restore
+    shared::restore(serial_map, serial_data);
+    shared::parallel::restore(parallel_map, parallel_data, 4);
+    
+    const std::string restored = shared::debug::dump(serial_map, shared::debug::DUMP_CSV);
+    if(shared::debug::dump(parallel_map, shared::debug::DUMP_CSV) != restored) return 7;
+    if(view != 1) return 8;
+    
+    // The groups still share memory
+    if(shared::get<int>(parallel_map, "V1001") != 1) return 9;
+    view = 5;
+    if(shared::get<int>(parallel_map, "V1001") != 5) return 10;
+    
+    // Small maps and a single thread fall back to shared::snapshot
+    shared::map_type<std::string> small_map;
+    shared::create<int>(small_map, "A", 1);
+    auto small_data = shared::parallel::snapshot(small_map, 8);
+    shared::set<int>(small_map, "A", 2);
+    shared::parallel::restore(small_map, small_data, 8);
+    if(shared::get<int>(small_map, "A") != 1) return 11;
+    
+    // Thread safe maps
+    shared::thread_safe::ts_var_map_t<std::string> ts_map;
+    populate(ts_map);
+    auto ts_data = shared::parallel::snapshot(ts_map, 3);
+    mutate(ts_map);
+    shared::parallel::restore(ts_map, ts_data, 3);
+    if(shared::debug::dump(ts_map, shared::debug::DUMP_CSV) != restored) return 12;
+    
+    // Errors in the worker threads reach the caller
+    shared::map_type<std::string> fragile_map;
+    for(int i = 0; i < var_count; i++) {
+        shared::create<fragile_t>(fragile_map, "F" + std::to_string(i));
+    }
+    
+    fragile_t::copies = 0;
+    fragile_t::limit = var_count / 2;
+    
+    bool thrown = false;
+    try {
+        auto fragile_data = shared::parallel::snapshot(fragile_map, 4);
+    }
+    catch(const std::runtime_error &) {
+        thrown = true;
+    }
+    if(!thrown) return 13;
+    
+    // A failed restore doesn't leave the removed vars half re-created
+    fragile_t::limit = 1 << 30;
+    auto fragile_data = shared::parallel::snapshot(fragile_map, 4);
+    
+    for(int i = 0; i < var_count; i += 2) {
+        shared::remove(fragile_map, "F" + std::to_string(i));
+    }
+    
+    fragile_t::copies = 0;
+    fragile_t::limit = 0;
+    
+    thrown = false;
+    try {
+        shared::parallel::restore(fragile_map, fragile_data, 4);
+    }
+    catch(const std::runtime_error &) {
+        thrown = true;
+    }
+    if(!thrown) return 14;
+    
+    if(fragile_map.size() != std::size_t(var_count / 2)) return 15;
+    for(auto & [key, info] : fragile_map) {
+        if(info.ptr == nullptr) return 16;
+    }
+    
+    // Restored once the copies succeed
+    fragile_t::limit = 1 << 30;
+    shared::parallel::restore(fragile_map, fragile_data, 4);
+    if(fragile_map.size() != std::size_t(var_count)) return 17;
+    
+    std::cout << "parallel snapshot OK\n";
+    return 0;
+}
@@ -0,0 +1,92 @@
+#include "../shared_var/shared_var.hpp"
+#include "../shared_var/prefix_subscriptions.hpp"
+
+#include <iostream>
+
+using map_t = shared::map_type<std::string>;
+
+// Counts the calls, returns "result"
+struct counter_t {
+    int calls = 0;
+    bool result = true;
+    shared::event_t last_event = shared::VAR_CHANGED;
+    
+    static bool on_event(void * context, const shared::info_t<std::string> &, const shared::event_t event) {
+        counter_t & self = *reinterpret_cast<counter_t *>(context);
+        self.calls++;
+        self.last_event = event;
+        return self.result;
+    }
+};
+
+int main() {
+    map_t map;
+    shared::prefix::prefix_subscriptions_t subscriptions(map);
+    
+    counter_t motor;
+    counter_t motor_3;
+    counter_t everything;
+    
+    subscriptions.subscribe("motor/", &counter_t::on_event, &motor);
+    subscriptions.subscribe("motor/3/", &counter_t::on_event, &motor_3);
+    subscriptions.subscribe("", &counter_t::on_event, &everything);
+    if(subscriptions.size() != 3) return 1;
+    
+    // Vars created after subscribing, nested prefixes
+    shared::create<double>(map, "motor/3/speed", 0.0);
+    shared::create<double>(map, "motor/1/speed", 0.0);
+    shared::create<double>(map, "motors", 0.0);
+    
+    shared::notify(map, "motor/3/speed");
+    if(motor.calls != 1 || motor_3.calls != 1 || everything.calls != 1) return 2;
+    
+    shared::notify(map, "motor/1/speed");
+    if(motor.calls != 2 || motor_3.calls != 1 || everything.calls != 2) return 3;
+    
+    shared::notify(map, "motors");
+    if(motor.calls != 2 || everything.calls != 3) return 4;
+    
+    shared::remove(map, "motor/3/speed");
+    if(motor_3.calls != 2 || motor_3.last_event != shared::VAR_REMOVED) return 5;
+    
+    // Unsubscribing
+    subscriptions.unsubscribe("motor/", &counter_t::on_event, &motor);
+    shared::notify(map, "motor/1/speed");
+    if(motor.calls != 3 || everything.calls != 5) return 6;
+    
+    // Returning false unsubscribes
+    everything.result = false;
+    shared::notify(map, "motors");
+    shared::notify(map, "motors");
+    if(everything.calls != 6 || subscriptions.size() != 1) return 7;
+    
+    // The empty nodes are pruned, "motor/3/" is still there
+    if(subscriptions.node_count() != 1 + 8) return 8;
+    
+    subscriptions.unsubscribe("motor/3/", &counter_t::on_event, &motor_3);
+    if(subscriptions.size() != 0 || subscriptions.node_count() != 1) return 9;
+    
+    // Subscribing and unsubscribing different prefixes doesn't grow the trie
+    for(int i = 0; i < 1000; i++) {
+        const std::string prefix = "temp/" + std::to_string(i);
+        subscriptions.subscribe(prefix, &counter_t::on_event, &motor);
+        subscriptions.unsubscribe(prefix, &counter_t::on_event, &motor);
+    }
+    
+    if(subscriptions.node_count() != 1) return 10;
+    
+    // Unsubscribing the prefix of another subscription keeps the longer one
+    subscriptions.subscribe("a", &counter_t::on_event, &motor);
+    subscriptions.subscribe("abc", &counter_t::on_event, &motor_3);
+    subscriptions.unsubscribe("a", &counter_t::on_event, &motor);
+    if(subscriptions.node_count() != 4) return 11;
+    
+    // Callbacks returning false are pruned after the dispatch
+    motor_3.result = false;
+    shared::create<int>(map, "abcd", 0);
+    shared::notify(map, "abcd");
+    if(motor_3.calls != 3 || subscriptions.node_count() != 1) return 12;
+    
+    std::cout << "prefix subscriptions OK\n";
+    return 0;
+}
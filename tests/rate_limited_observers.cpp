@@ -0,0 +1,83 @@
+#include "../shared_var/shared_var.hpp"
+#include "../shared_var/timer_wheel.hpp"
+#include "../shared_var/rate_limit.hpp"
+
+#include <iostream>
+
+static void count_call(void * context) {
+    (*reinterpret_cast<int *>(context))++;
+}
+
+static void save_value(void * context, const double & value) {
+    *reinterpret_cast<double *>(context) = value;
+}
+
+int main() {
+// ===== Timer wheel =====
+    
+    shared::timer::timer_wheel_t wheel;
+    
+    // Timers in every level and in the overflow list
+    int calls[5] = {};
+    const shared::timer::timer_wheel_t::tick_type delays[5] = {1, 63, 64, 5000, (1 << 24) + 3};
+    
+    for(int i = 0; i < 5; i++) {
+        wheel.schedule(delays[i], &count_call, &calls[i]);
+    }
+    
+    for(int i = 0; i < 5; i++) {
+        wheel.advance_to(delays[i] - 1);
+        if(calls[i] != 0) return 1;
+        
+        wheel.advance_to(delays[i]);
+        if(calls[i] != 1) return 2;
+    }
+    
+    // Cancelled timers never fire
+    int cancelled = 0;
+    auto handle = wheel.schedule(10, &count_call, &cancelled);
+    if(!wheel.cancel(handle) || wheel.cancel(handle)) return 3;
+    wheel.advance(100);
+    if(cancelled != 0 || wheel.size() != 0) return 4;
+    
+// ===== Rate limited observers =====
+    
+    shared::map_type<std::string> map;
+    auto sensor = shared::make_var<double>(map, "sensor", 0.0);
+    
+    double throttled_value = 0.0;
+    double debounced_value = 0.0;
+    
+    shared::rate_limit::limited_observer_t<double, shared::map_type<std::string>> throttled(
+        map, "sensor", wheel, shared::rate_limit::THROTTLE, 10, &save_value, &throttled_value
+    );
+    shared::rate_limit::limited_observer_t<double, shared::map_type<std::string>> debounced(
+        map, "sensor", wheel, shared::rate_limit::DEBOUNCE, 5, &save_value, &debounced_value
+    );
+    
+    // One write per tick during 100 ticks
+    for(int i = 1; i <= 100; i++) {
+        sensor = double(i);
+        sensor.notify();
+        wheel.advance(1);
+    }
+    
+    // Throttled: about one delivery every 10 ticks, with the latest value
+    if(throttled.changes() != 100) return 5;
+    if(throttled.deliveries() < 9 || throttled.deliveries() > 11) return 6;
+    
+    // Debounced: the writes never stopped
+    if(debounced.deliveries() != 0) return 7;
+    
+    wheel.advance(20);
+    if(throttled_value != 100.0 || debounced_value != 100.0) return 8;
+    if(debounced.deliveries() != 1) return 9;
+    
+    // Removing the var stops the observers
+    shared::remove(map, "sensor");
+    if(throttled.is_observing() || debounced.is_observing()) return 10;
+    
+    std::cout << "ok\n";
+    
+    return 0;
+}
@@ -0,0 +1,254 @@
+// Long running stress of the map topology.
+// Builds a map with millions of vars, then applies a random stream of
+// create, bind, unbind, isolate, remove and write while views of some vars
+// stay alive. The topology invariants are checked periodically, a snapshot is
+// taken at every check and restored halfway to the next one.
+// The throughput and memory are reported over time.
+//
+// Usage: stress_topology [vars = 2000000] [seconds = 60] [seed = 1]
+// Returns 1 if an invariant is broken.
+
+#include "../shared_var/shared_var.hpp"
+#include "../shared_var/memory_stats.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+using key_type = std::uint64_t;
+using map_t = shared::map_type<key_type>;
+using view_t = shared::var_view_t<std::int64_t, map_t>;
+using clock_type = std::chrono::steady_clock;
+
+// The first vars have views, they are never removed
+static constexpr key_type pinned_count = 1024;
+
+// Binds stay inside aligned blocks of vars, except the rare long range ones,
+// so the groups stay small enough for millions of operations
+static constexpr key_type block_size = 64;
+
+// Invariants, memory and snapshots every period, restores halfway
+static constexpr auto check_period = std::chrono::seconds(10);
+
+// Every broken invariant found, printed once
+static bool report_failure(const std::string & message) {
+    std::cerr << "INVARIANT BROKEN: " << message << "\n";
+    return false;
+}
+
+// Refs are symmetric, bound vars share the group and the memory,
+// views follow the memory of their var
+static bool check_invariants(map_t & map, const std::vector<std::unique_ptr<view_t>> & views) {
+    for(const auto & [key, info] : map) {
+        if(info.key != key) {
+            return report_failure("var " + std::to_string(key) + " has the key " + std::to_string(info.key));
+        }
+        
+        if(info.ptr == nullptr) {
+            return report_failure("var " + std::to_string(key) + " has no memory");
+        }
+        
+        for(const key_type & ref_key : info.refs) {
+            auto it = map.find(ref_key);
+            
+            if(it == map.end()) {
+                return report_failure("var " + std::to_string(key) + " refs the removed var " + std::to_string(ref_key));
+            }
+            
+            const shared::info_t<key_type> & ref = it->second;
+            
+            if(!ref.refs.contains(key)) {
+                return report_failure("ref " + std::to_string(key) + " -> " + std::to_string(ref_key) + " is not symmetric");
+            }
+            
+            if(ref.group_id != info.group_id || ref.ptr != info.ptr) {
+                return report_failure("bound vars " + std::to_string(key) + " and " + std::to_string(ref_key) + " don't share memory");
+            }
+        }
+        
+        for(void ** pointer_to_var : info.pointers_to_var) {
+            if(*pointer_to_var != info.ptr.get()) {
+                return report_failure("a view of " + std::to_string(key) + " points to old memory");
+            }
+        }
+    }
+    
+    for(key_type key = 0; key < views.size(); key++) {
+        const std::int64_t * ptr = shared::get_ptr<std::int64_t>(map, key);
+        
+        if(ptr == nullptr || views[key]->ptr() != ptr) {
+            return report_failure("the view of " + std::to_string(key) + " doesn't point to its var");
+        }
+    }
+    
+    return true;
+}
+
+int main(int argc, char ** argv) {
+    const key_type var_count = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 2000000;
+    const double seconds = argc > 2 ? std::strtod(argv[2], nullptr) : 60.0;
+    const std::uint64_t seed = argc > 3 ? std::strtoull(argv[3], nullptr, 10) : 1;
+    
+    if(var_count < pinned_count * 2) {
+        std::cerr << "at least " << pinned_count * 2 << " vars\n";
+        return 2;
+    }
+    
+    std::mt19937_64 rng(seed);
+    const auto random_key = [&]() { return key_type(rng() % var_count); };
+    
+// ===== build =====
+    
+    map_t map;
+    auto start = clock_type::now();
+    
+    for(key_type key = 0; key < var_count; key++) {
+        shared::create<std::int64_t>(map, key, std::int64_t(key));
+    }
+    
+    std::vector<std::unique_ptr<view_t>> views;
+    for(key_type key = 0; key < pinned_count; key++) {
+        views.push_back(std::make_unique<view_t>(map, key));
+    }
+    
+    std::cout << "built " << var_count << " vars in "
+              << std::chrono::duration<double>(clock_type::now() - start).count() << " s\n";
+
+// ===== churn =====
+    
+    enum operation_t { CREATE, BIND, BIND_FAR, UNBIND, ISOLATE, REMOVE, WRITE, SNAPSHOT, RESTORE, OPERATION_COUNT };
+    const char * names[OPERATION_COUNT] = {"create", "bind", "bind_far", "unbind", "isolate", "remove", "write", "snapshot", "restore"};
+    
+    // Out of 1000000 operations. Snapshot and restore walk the whole map,
+    // they are scheduled with the checks instead of picked at random
+    const std::uint32_t weights[OPERATION_COUNT] = {150000, 250000, 100, 140000, 50000, 100000, 309900, 0, 0};
+    
+    std::uint64_t counts[OPERATION_COUNT] = {};
+    
+    // Restored once, halfway to the next check
+    std::vector<shared::info_t<key_type>> snapshot = shared::snapshot(map);
+    bool is_restore_due = true;
+    counts[SNAPSHOT]++;
+    
+    const auto end = clock_type::now() + std::chrono::duration_cast<clock_type::duration>(std::chrono::duration<double>(seconds));
+    auto last_report = clock_type::now();
+    auto last_check = last_report;
+    std::uint64_t operations = 0;
+    std::uint64_t operations_at_report = 0;
+    
+    start = clock_type::now();
+    
+    while(clock_type::now() < end) {
+        // A batch between clock reads
+        for(int i = 0; i < 1024; i++) {
+            std::uint32_t pick = std::uint32_t(rng() % 1000000);
+            int operation = 0;
+            while(pick >= weights[operation]) {
+                pick -= weights[operation];
+                operation++;
+            }
+            
+            const key_type key = random_key();
+            
+            switch(operation) {
+                case CREATE:
+                    shared::create<std::int64_t>(map, key, std::int64_t(key));
+                    break;
+                    
+                case BIND: {
+                    const key_type other = std::min(key - key % block_size + rng() % block_size, var_count - 1);
+                    shared::bind(map, key, other);
+                    break;
+                }
+                
+                case BIND_FAR:
+                    shared::bind(map, key, random_key());
+                    break;
+                    
+                case UNBIND: {
+                    auto it = map.find(key);
+                    if(it != map.end() && !it->second.refs.empty()) {
+                        const key_type other = *it->second.refs.begin();
+                        shared::unbind(map, key, other);
+                    }
+                    break;
+                }
+                
+                case ISOLATE:
+                    shared::isolate(map, key);
+                    break;
+                    
+                case REMOVE:
+                    if(key >= pinned_count) {
+                        shared::remove(map, key);
+                    }
+                    break;
+                    
+                case WRITE:
+                    if(key < pinned_count) {
+                        *views[key] = std::int64_t(rng());
+                    }
+                    else {
+                        shared::set<std::int64_t>(map, key, std::int64_t(rng()));
+                    }
+                    break;
+            }
+            
+            counts[operation]++;
+            operations++;
+        }
+        
+        const auto now = clock_type::now();
+        
+        // Throughput of the last second
+        if(now - last_report >= std::chrono::seconds(1)) {
+            const double interval = std::chrono::duration<double>(now - last_report).count();
+            
+            std::cout << "t=" << std::chrono::duration<double>(now - start).count() << " s"
+                      << " ops/s=" << std::uint64_t(double(operations - operations_at_report) / interval)
+                      << " vars=" << map.size() << "\n";
+
+            last_report = now;
+            operations_at_report = operations;
+        }
+        
+        // The last snapshot, halfway between checks
+        if(is_restore_due && now - last_check >= check_period / 2) {
+            shared::restore(map, snapshot);
+            counts[RESTORE]++;
+            is_restore_due = false;
+        }
+        
+        // Invariants, memory and the next snapshot
+        if(now - last_check >= check_period) {
+            if(!check_invariants(map, views)) return 1;
+            
+            const auto stats = shared::memory::memory_stats(map);
+            std::cout << "checked: groups=" << stats.groups
+                      << " bytes=" << stats.total()
+                      << " bytes/var=" << (map.size() != 0 ? stats.total() / map.size() : 0) << "\n";
+            
+            snapshot = shared::snapshot(map);
+            is_restore_due = true;
+            counts[SNAPSHOT]++;
+            
+            last_check = clock_type::now();
+        }
+    }
+    
+    if(!check_invariants(map, views)) return 1;
+    
+    std::cout << operations << " operations:";
+    for(int operation = 0; operation < OPERATION_COUNT; operation++) {
+        std::cout << " " << names[operation] << "=" << counts[operation];
+    }
+    std::cout << "\nOK\n";
+    
+    return 0;
+}
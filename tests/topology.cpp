@@ -0,0 +1,80 @@
+#include "../shared_var/shared_var.hpp"
+
+#include <iostream>
+
+using map_t = shared::map_type<std::string>;
+
+// Every var shares the memory of its refs, and the refs are symmetric
+bool is_consistent(map_t & map) {
+    for(const auto & [key, info] : map) {
+        for(const std::string & ref : info.refs) {
+            auto it = map.find(ref);
+            
+            if(it == map.end() || it->second.ptr != info.ptr || !it->second.refs.contains(key)) {
+                return false;
+            }
+        }
+    }
+    
+    return true;
+}
+
+int main() {
+    // Binding a var to itself does nothing
+    {
+        map_t map;
+        shared::create<int>(map, "A", 1);
+        shared::bind(map, "A", "B");
+        
+        shared::bind(map, "A", "A");
+        if(map["A"].refs.contains("A") || map["A"].refs.size() != 1) return 1;
+        
+        // The self ref was erased while iterated
+        shared::isolate(map, "A");
+        shared::remove(map, "B");
+        shared::remove(map, "A");
+        if(!map.empty()) return 2;
+    }
+    
+    // Group ids are var keys, after these unbinds "B" and "D" are in
+    // different groups with the same id. The memory tells them apart.
+    {
+        map_t map;
+        shared::create<int>(map, "A", 0);
+        shared::create<int>(map, "B", 0);
+        shared::create<int>(map, "C", 0);
+        shared::create<int>(map, "D", 0);
+        
+        shared::bind(map, "A", "D");
+        shared::bind(map, "B", "A");
+        shared::unbind(map, "D", "A");
+        shared::unbind(map, "B", "A");
+        shared::bind(map, "D", "B");
+        if(!is_consistent(map)) return 3;
+        
+        shared::set<int>(map, "D", 5);
+        if(shared::get<int>(map, "B") != 5) return 4;
+    }
+    
+    // Restore re-creates removed vars without their refs,
+    // so they start in their own group
+    {
+        map_t map;
+        shared::create<int>(map, "A", 1);
+        shared::bind(map, "A", "B");
+        
+        const auto data = shared::snapshot(map);
+        shared::remove(map, "B");
+        shared::restore(map, data);
+        
+        if(map["B"].group_id != "B" || !map["B"].refs.empty()) return 5;
+        if(shared::get<int>(map, "B") != 1 || map["A"].ptr == map["B"].ptr) return 6;
+        
+        shared::bind(map, "A", "B");
+        shared::set<int>(map, "B", 2);
+        if(!is_consistent(map) || shared::get<int>(map, "A") != 2) return 7;
+    }
+    
+    std::cout << "topology OK\n";
+    return 0;
+}